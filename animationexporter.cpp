@@ -0,0 +1,269 @@
+#include "animationexporter.h"
+#include <QtConcurrent>
+#include <QSvgGenerator>
+#include <QThread>
+#include <QDir>
+#include <QFile>
+
+QPointF AnimationExporter::View::map(double x, double y) const
+{
+    return QPointF((x - xRange.lower) / xRange.size() * size.width(),
+                   (yRange.upper - y) / yRange.size() * size.height());
+}
+
+AnimationExporter::AnimationExporter(SVE::EngineSnapshot<double> engine, const std::map<CycleEnum, QBrush> &regionBrush, QPen thickPen, QObject *parent)
+    : QObject(parent)
+    , _engine(engine)
+    , _regionBrush(regionBrush)
+    , _thickPen(thickPen)
+{
+    _frames = 0;
+    _format = Format::png;
+    _framesDone = 0;
+    _framesReported = 0;
+    _cancelled = false;
+    _progressTimer.setInterval(50);
+    connect(&_progressTimer, SIGNAL(timeout()), this, SLOT(updateProgress()));
+    connect(&_watcher, SIGNAL(finished()), this, SLOT(workersFinished()));
+}
+
+AnimationExporter::~AnimationExporter()
+{
+    // the workers use this object, so they have to stop first
+    cancel();
+    _watcher.waitForFinished();
+}
+
+/*!
+ * starts rendering in the global thread pool. Files are named valve_NNNN and cycle_NNNN in <directory>
+ * \param valveView     area of the valve diagram to render, and the image size
+ * \param cycleView     area of the cycle diagram to render, and the image size
+ * \param directory     directory for the image files
+ * \param frames        number of frames, evenly spaced over one revolution
+ * \param format        image file format
+ */
+void AnimationExporter::start(View valveView, View cycleView, QString directory, int frames, Format format)
+{
+    _valveView = valveView;
+    _cycleView = cycleView;
+    _directory = directory;
+    _frames = frames;
+    _format = format;
+    _framesDone = 0;
+    _framesReported = 0;
+    _cancelled = false;
+    _error.clear();
+
+    // the cycle diagram curves are the same in every frame, only the tracer moves. Sample them for the image resolution
+    SVE::SampleResolution<double> resolution;
+    resolution.viewLower = cycleView.xRange.lower;
+    resolution.viewUpper = cycleView.xRange.upper;
+    resolution.viewXScale = cycleView.size.width() / cycleView.xRange.size();
+    resolution.viewYScale = cycleView.size.height() / cycleView.yRange.size();
+    resolution.xScale = resolution.viewXScale;
+    resolution.yScale = resolution.viewYScale;
+    resolution.tolerance = 0.25;
+    _cycleSegments = CycleDiagram::segments(*_engine, -180, 440, resolution);
+
+    // split the frames evenly between the workers
+    int workers = qMax(1, QThread::idealThreadCount());
+    _workerFrames.clear();
+    for (int i=0; i<workers; i++){
+        int first = frames * i / workers;
+        int last = frames * (i + 1) / workers;
+        if (last > first)
+            _workerFrames.append(FrameRange(first, last));
+    }
+
+    _watcher.setFuture(QtConcurrent::map(_workerFrames, [this](const FrameRange &range){ renderFrames(range); }));
+    _progressTimer.start();
+}
+
+/*!
+ * reports the frames done so far. The workers only count, so the progress is always reported in order
+ */
+void AnimationExporter::updateProgress()
+{
+    int done = _framesDone;
+    if (done > _framesReported){
+        _framesReported = done;
+        emit frameFinished(done);
+    }
+}
+
+void AnimationExporter::workersFinished()
+{
+    _progressTimer.stop();
+    updateProgress();
+    QString error = errorString();
+    if (!error.isEmpty())
+        emit failed(error);
+    emit finished();
+}
+
+/*!
+ * records the first write error and stops the other workers. Called from the worker threads
+ */
+void AnimationExporter::fail(const QString &error)
+{
+    QMutexLocker lock(&_errorMutex);
+    if (_error.isEmpty())
+        _error = error;
+    _cancelled = true;
+}
+
+QString AnimationExporter::errorString() const
+{
+    QMutexLocker lock(&_errorMutex);
+    return _error;
+}
+
+/*!
+ * writes one SVG frame, checking the file can be opened and is completely written
+ * \return false if the file could not be written (the error is recorded with fail())
+ */
+bool AnimationExporter::saveSvg(const QString &fileName, const View &view, const std::function<void(QCPPainter *)> &paint)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)){
+        fail("Could not write " + fileName + ": " + file.errorString());
+        return false;
+    }
+    QSvgGenerator svg;
+    svg.setOutputDevice(&file);
+    svg.setSize(view.size);
+    svg.setViewBox(QRect(QPoint(0, 0), view.size));
+    QCPPainter painter(&svg);
+    if (!painter.isActive()){
+        fail("Could not write " + fileName);
+        return false;
+    }
+    painter.fillRect(QRect(QPoint(0, 0), view.size), Qt::white);
+    paint(&painter);
+    painter.end();
+    if (!file.flush() || file.error() != QFileDevice::NoError){
+        fail("Could not write " + fileName + ": " + file.errorString());
+        return false;
+    }
+    return true;
+}
+
+void AnimationExporter::cancel()
+{
+    _cancelled = true;
+}
+
+int AnimationExporter::frameCount() const
+{
+    return _frames;
+}
+
+void AnimationExporter::renderFrames(const FrameRange &range)
+{
+    // the engine snapshot is shared by all workers, each has its own diagram and images
+    const SlideValveEngine &engine = *_engine;
+    ValveDiagram diagram(engine.getEngineParams(), _regionBrush);
+    QDir directory(_directory);
+
+    QImage valveImage(_valveView.size, QImage::Format_ARGB32_Premultiplied);
+    QImage cycleImage(_cycleView.size, QImage::Format_ARGB32_Premultiplied);
+    QImage cycleBackground;
+    if (_format == Format::png){
+        // the cycle curves don't move, so raster them once per worker and only draw the tracer per frame
+        cycleBackground = QImage(_cycleView.size, QImage::Format_ARGB32_Premultiplied);
+        cycleBackground.fill(Qt::white);
+        QCPPainter painter(&cycleBackground);
+        paintCycleCurves(&painter);
+    }
+
+    for (int frame = range.first; frame < range.second && !_cancelled; frame++)
+    {
+        double crank = 360.0 * frame / _frames;
+        QString number = QString("%1").arg(frame, 4, 10, QChar('0'));
+
+        if (_format == Format::png){
+            valveImage.fill(Qt::white);
+            QCPPainter valvePainter(&valveImage);
+            paintValveFrame(&valvePainter, diagram, engine, crank);
+            valvePainter.end();
+            QString valveFile = directory.filePath("valve_" + number + ".png");
+            if (!valveImage.save(valveFile)){
+                fail("Could not write " + valveFile);
+                return;
+            }
+
+            cycleImage = cycleBackground.copy();
+            QCPPainter cyclePainter(&cycleImage);
+            paintCycleTracer(&cyclePainter, engine, crank);
+            cyclePainter.end();
+            QString cycleFile = directory.filePath("cycle_" + number + ".png");
+            if (!cycleImage.save(cycleFile)){
+                fail("Could not write " + cycleFile);
+                return;
+            }
+        }else{
+            if (!saveSvg(directory.filePath("valve_" + number + ".svg"), _valveView,
+                         [&](QCPPainter *painter){ paintValveFrame(painter, diagram, engine, crank); }))
+                return;
+            if (!saveSvg(directory.filePath("cycle_" + number + ".svg"), _cycleView,
+                         [&](QCPPainter *painter){ paintCycleCurves(painter); paintCycleTracer(painter, engine, crank); }))
+                return;
+        }
+        ++_framesDone;
+    }
+}
+
+/*!
+ * paints the valve diagram polygons for crank position <crank>, the same way MainWindow::drawValveDiagram plots them
+ */
+void AnimationExporter::paintValveFrame(QCPPainter *painter, const ValveDiagram &diagram, const SlideValveEngine &engine, double crank) const
+{
+    painter->setAntialiasing(true);
+    QVector<ValveDiagram::Shape> shapes = diagram.shapes(engine.crank2Stroke(crank), engine.crank2ValvePos(crank),
+                                                         engine.crank2TopCycle(crank), engine.crank2BotCycle(crank));
+    for (const ValveDiagram::Shape &shape : shapes)
+    {
+        QPolygonF polygon;
+        for (auto it = shape.data.constBegin(); it != shape.data.constEnd(); ++it)
+            polygon << _valveView.map(it->key, it->value);
+        painter->setPen(shape.pen);
+        painter->setBrush(shape.brush);
+        painter->drawPolygon(polygon);
+    }
+}
+
+/*!
+ * paints the shaded cycle diagram curves, the same way MainWindow::drawCycleDiagram plots them
+ */
+void AnimationExporter::paintCycleCurves(QCPPainter *painter) const
+{
+    painter->setAntialiasing(true);
+    for (const CycleDiagram::Segment &segment : _cycleSegments)
+    {
+        // filled down to 0, like a QCPGraph with a brush
+        QPolygonF line;
+        line.reserve(segment.data.size() + 2);
+        for (const QCPGraphData &point : segment.data)
+            line << _cycleView.map(point.key, point.value);
+        QPolygonF fill = line;
+        fill << _cycleView.map(segment.data.last().key, 0) << _cycleView.map(segment.data.first().key, 0);
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(_regionBrush.at(segment.cycle));
+        painter->drawPolygon(fill);
+        painter->setPen(segment.top ? _thickPen : QPen(Qt::blue, 0));     // bottom regions keep the default QCPGraph pen
+        painter->setBrush(Qt::NoBrush);
+        painter->drawPolyline(line);
+    }
+}
+
+/*!
+ * paints the tracer marking crank position <crank> on the cycle diagram
+ */
+void AnimationExporter::paintCycleTracer(QCPPainter *painter, const SlideValveEngine &engine, double crank) const
+{
+    // same style as the tracer graph
+    painter->setAntialiasing(true);
+    painter->setPen(QPen(Qt::red));
+    painter->setBrush(Qt::white);
+    painter->drawEllipse(_cycleView.map(crank, engine.crank2Stroke(crank)), 5, 5);
+}
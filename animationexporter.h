@@ -0,0 +1,87 @@
+#ifndef ANIMATIONEXPORTER_H
+#define ANIMATIONEXPORTER_H
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <QObject>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QTimer>
+#include "qcustomplot.h"
+#include "enginesnapshot.h"
+#include "cyclediagram.h"
+#include "valvediagram.h"
+
+/*!
+ * Renders the valve diagram and the cycle diagram for a series of crank positions to numbered image files.
+ * Frames are painted by worker threads, each with its own offscreen image and QCPPainter, so the visible plots are not touched.
+ * (QCustomPlot widgets can only live in the GUI thread, so the workers paint the diagram geometry directly.)
+ * The first file that cannot be written stops the export, failed() reports it before finished().
+ */
+class AnimationExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Format { png, svg };
+
+    // the part of the diagram to render, and the image size
+    struct View
+    {
+        QCPRange xRange;
+        QCPRange yRange;
+        QSize size;
+
+        QPointF map(double x, double y) const;      // plot coordinates to image pixels
+    };
+
+    AnimationExporter(SVE::EngineSnapshot<double> engine, const std::map<CycleEnum, QBrush> &regionBrush, QPen thickPen, QObject *parent = nullptr);
+    ~AnimationExporter();
+
+    void start(View valveView, View cycleView, QString directory, int frames, Format format);     // starts the workers and returns immediately
+    int frameCount() const;
+    QString errorString() const;            // first write error, empty if there was none
+
+public slots:
+    void cancel();
+
+signals:
+    void frameFinished(int framesDone);     // progress, emitted in the GUI thread with increasing counts
+    void failed(QString error);             // a frame could not be written, the export stopped
+    void finished();
+
+private slots:
+    void updateProgress();
+    void workersFinished();
+
+private:
+    typedef QPair<int, int> FrameRange;     // [first, last) frame numbers rendered by one worker
+
+    SVE::EngineSnapshot<double> _engine;
+    std::map<CycleEnum, QBrush> _regionBrush;
+    QPen _thickPen;
+    QVector<CycleDiagram::Segment> _cycleSegments;
+    View _valveView;
+    View _cycleView;
+    QString _directory;
+    int _frames;
+    Format _format;
+    QVector<FrameRange> _workerFrames;
+    std::atomic<int> _framesDone;
+    std::atomic<bool> _cancelled;
+    QFutureWatcher<void> _watcher;
+    QTimer _progressTimer;                  // polls _framesDone from the GUI thread
+    int _framesReported;
+    mutable QMutex _errorMutex;
+    QString _error;                         // first write error, guarded by _errorMutex
+
+    void renderFrames(const FrameRange &range);
+    void fail(const QString &error);
+    bool saveSvg(const QString &fileName, const View &view, const std::function<void(QCPPainter *)> &paint);
+    void paintValveFrame(QCPPainter *painter, const ValveDiagram &diagram, const SlideValveEngine &engine, double crank) const;
+    void paintCycleCurves(QCPPainter *painter) const;
+    void paintCycleTracer(QCPPainter *painter, const SlideValveEngine &engine, double crank) const;
+};
+
+#endif // ANIMATIONEXPORTER_H
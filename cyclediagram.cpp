@@ -0,0 +1,76 @@
+#include "cyclediagram.h"
+#include "tracing.h"
+
+/*!
+ * generates the shaded regions of the cycle diagram between two crank positions
+ * \param engine        engine to evaluate
+ * \param crankStart    first crank position (degrees, may be negative or past 360 to show wrap around)
+ * \param crankStop     last crank position
+ * \param resolution    pixel resolution the position curve is sampled for
+ * \return              bottom side regions (flat at <stroke>, to be over-drawn by the position curve) followed by the top side regions
+ */
+QVector<CycleDiagram::Segment> CycleDiagram::segments(const SlideValveEngine &engine, double crankStart, double crankStop, const SVE::SampleResolution<double> &resolution)
+{
+    TRACE_SCOPE("CycleDiagram::segments");
+    QVector<Segment> segments;
+    double stroke = engine.getEngineParams().stroke;
+
+    // draw shaded regions from <stroke> to the X-Axis for the bottom port regions
+    // these will be over-drawn by the position curve
+    double crankPos = crankStart;
+
+    // get the critical points
+    auto foo = engine.botCriticalPoints();
+    //find the index of the first point after the starting position
+    int nextIndex = engine.nextBotCriticalPoint(crankPos);
+    while (crankPos < crankStop)
+    {
+        // make segment from crank position to next critical point (or end whichever comes first)
+        Segment segment;
+        double diff = SVE::addAngles(foo[nextIndex], -crankPos);
+        if (diff < 0)
+            diff +=360;
+        double nextCrankPos = crankPos + diff;
+        if (++nextIndex ==4)
+                nextIndex = 0;
+        // set the fill color based on region
+        segment.cycle = engine.crank2BotCycle((crankPos+nextCrankPos)/2);
+        segment.top = false;
+        if (nextCrankPos > crankStop)
+           nextCrankPos = crankStop;
+        segment.data = QVector<QCPGraphData>{QCPGraphData(crankPos, stroke), QCPGraphData(nextCrankPos, stroke)};
+        segments.append(segment);
+        crankPos = nextCrankPos;
+    }
+
+    crankPos = crankStart;
+    std::vector<double> x, y;           // samples of the current segment, the buffers are reused for all segments
+    foo = engine.topCriticalPoints();
+    nextIndex = engine.nextTopCriticalPoint(crankPos);
+    while (crankPos < crankStop)
+    {
+        // make segment from crank position to next critical point (or end whichever comes first)
+        Segment segment;
+        double diff = SVE::addAngles(foo[nextIndex], -crankPos);
+        if (diff < 0)
+            diff +=360;
+        double nextCrankPos = crankPos + diff;
+        if (++nextIndex ==4)
+                nextIndex = 0;
+        // set the fill color based on region
+        segment.cycle = engine.crank2TopCycle((crankPos + nextCrankPos) / 2);
+        segment.top = true;
+        if (nextCrankPos > crankStop)
+            nextCrankPos = crankStop;
+        // sample the position curve only as finely as the plot resolution needs
+        x.clear();
+        y.clear();
+        SVE::sampleAdaptive([&engine](double deg){ return engine.crank2Stroke(deg); }, crankPos, nextCrankPos, resolution, x, y);
+        segment.data.reserve(x.size());
+        for (size_t i=0; i<x.size(); i++)
+            segment.data.append(QCPGraphData(x[i], y[i]));
+        crankPos = nextCrankPos;
+        segments.append(segment);
+    }
+    return segments;
+}
@@ -0,0 +1,27 @@
+#ifndef CYCLEDIAGRAM_H
+#define CYCLEDIAGRAM_H
+
+#include <QVector>
+#include "qcustomplot.h"
+#include "slidevalveengine.h"
+
+/*!
+ * Generates the curves of the cycle diagram (piston position vs crank position, shaded by cycle region).
+ * Pure data, so it can be used for the interactive plot and for offscreen rendering from worker threads.
+ */
+class CycleDiagram
+{
+public:
+    // one shaded region of the diagram. the curve is filled down to 0
+    struct Segment
+    {
+        QVector<QCPGraphData> data; // crank position (degrees) and piston offset from TDC, in crank order
+        CycleEnum cycle;            // cycle region the segment is shaded for
+        bool top;                   // true for the piston position curve (top side regions), false for the flat bottom side regions
+    };
+
+    // the segment data is built in plot order, so it can be handed to QCPDataContainer::set(data, true) or adopt() without sorting
+    static QVector<Segment> segments(const SlideValveEngine &engine, double crankStart, double crankStop, const SVE::SampleResolution<double> &resolution);      // bottom side regions first, then the top side regions
+};
+
+#endif // CYCLEDIAGRAM_H
@@ -0,0 +1,230 @@
+#include "designbatch.h"
+#include <limits>
+
+template <typename T>
+SVE::AngleGrid<T>::AngleGrid(T start, T stop, int steps)
+{
+    _degrees.resize(steps + 1);
+    _cos.resize(steps + 1);
+    _sin.resize(steps + 1);
+    for (int i=0; i<=steps; i++){
+        T deg = (i == steps) ? stop : start + (stop - start) * i / steps;
+        _degrees[i] = deg;
+        _cos[i] = std::cos(SVE::deg2Rad(deg));
+        _sin[i] = std::sin(SVE::deg2Rad(deg));
+    }
+}
+
+template <typename T>
+int SVE::AngleGrid<T>::size() const
+{
+    return static_cast<int>(_degrees.size());
+}
+
+template <typename T>
+const std::vector<T> &SVE::AngleGrid<T>::degrees() const
+{
+    return _degrees;
+}
+
+template <typename T>
+const std::vector<T> &SVE::AngleGrid<T>::cos() const
+{
+    return _cos;
+}
+
+template <typename T>
+const std::vector<T> &SVE::AngleGrid<T>::sin() const
+{
+    return _sin;
+}
+
+/*!
+ * evaluates the piston and valve positions, and the exahust flow widths, of all designs in one pass over the grid
+ * the valve angle (crank + eccentric advance) is formed with the angle sum identities from the grid cos/sin,
+ * so there are no trig calls inside the loop
+ * \param grid      crank angles
+ * \param designs   engine parameters of each design
+ * \return positions, design major
+ */
+template <typename T>
+SVE::DesignBatch<T> SVE::evaluateBatch(const AngleGrid<T> &grid, const std::vector<s_engineParamsT<T>> &designs)
+{
+    const int n = grid.size();
+    const T *gridCos = grid.cos().data();
+    const T *gridSin = grid.sin().data();
+
+    DesignBatch<T> batch;
+    batch.gridSize = n;
+    batch.stroke.resize(designs.size() * n);
+    batch.valvePos.resize(designs.size() * n);
+    batch.topExahust.resize(designs.size() * n);
+    batch.botExahust.resize(designs.size() * n);
+
+    for (size_t d=0; d<designs.size(); d++){
+        const s_engineParamsT<T> &params = designs[d];
+        T r = params.stroke / T(2.0);
+        T l2 = params.conRod * params.conRod;
+        T vr = params.valveTravel / T(2.0);
+        T vl2 = params.valveConRod * params.valveConRod;
+        T advCos = std::cos(SVE::deg2Rad(params.eccentricAdvance));
+        T advSin = std::sin(SVE::deg2Rad(params.eccentricAdvance));
+        T *stroke = batch.stroke.data() + d * n;
+        T *valvePos = batch.valvePos.data() + d * n;
+        T *topExahust = batch.topExahust.data() + d * n;
+        T *botExahust = batch.botExahust.data() + d * n;
+
+        for (int i=0; i<n; i++){
+            // piston, as SVE::crank2Stroke
+            T rSin = r * gridSin[i];
+            stroke[i] = params.conRod + r - (r * gridCos[i] + std::sqrt(l2 - rSin*rSin));
+
+            // valve, as SlideValveEngine::crank2ValvePos (eccentric angle = crank + advance)
+            T eccCos = gridCos[i] * advCos - gridSin[i] * advSin;
+            T eccSin = gridSin[i] * advCos + gridCos[i] * advSin;
+            T vrSin = vr * eccSin;
+            valvePos[i] = params.valveConRod + vr - (vr * eccCos + std::sqrt(vl2 - vrSin*vrSin)) - vr;
+
+            topExahust[i] = SVE::exahustFlow(params, valvePos[i], false).width;
+            botExahust[i] = SVE::exahustFlow(params, valvePos[i], true).width;
+        }
+    }
+    return batch;
+}
+
+/*!
+ * evaluates the valve rod, eccentric strap and eccentric torque loads of all designs in one pass over the grid
+ * the eccentric angle is formed from the grid cos/sin as in evaluateBatch, so there are no trig calls inside the loop
+ * \param grid      crank angles, usually one full revolution
+ * \param designs   engine parameters of each design
+ * \param settings  operating point shared by all designs
+ * \return loads, design major, and the peaks of each design over the grid
+ */
+template <typename T>
+SVE::ValveLoadBatch<T> SVE::valveLoads(const AngleGrid<T> &grid, const std::vector<s_engineParamsT<T>> &designs, const s_valveLoadSettingsT<T> &settings)
+{
+    const int n = grid.size();
+    const T *gridCos = grid.cos().data();
+    const T *gridSin = grid.sin().data();
+
+    ValveLoadBatch<T> batch;
+    batch.gridSize = n;
+    batch.rodForce.resize(designs.size() * n);
+    batch.strapForce.resize(designs.size() * n);
+    batch.eccentricTorque.resize(designs.size() * n);
+    batch.peakRodForce.resize(designs.size());
+    batch.peakStrapForce.resize(designs.size());
+    batch.rmsStrapForce.resize(designs.size());
+
+    for (size_t d=0; d<designs.size(); d++){
+        const s_engineParamsT<T> &params = designs[d];
+        T advCos = std::cos(SVE::deg2Rad(params.eccentricAdvance));
+        T advSin = std::sin(SVE::deg2Rad(params.eccentricAdvance));
+        T *rodForce = batch.rodForce.data() + d * n;
+        T *strapForce = batch.strapForce.data() + d * n;
+        T *eccentricTorque = batch.eccentricTorque.data() + d * n;
+        T peakRod = 0;
+        T peakStrap = 0;
+        T sumSquares = 0;
+
+        for (int i=0; i<n; i++){
+            T eccCos = gridCos[i] * advCos - gridSin[i] * advSin;
+            T eccSin = gridSin[i] * advCos + gridCos[i] * advSin;
+            s_valveLoadT<T> load = SVE::valveLoad(params, settings, eccCos, eccSin);
+            rodForce[i] = load.rodForce;
+            strapForce[i] = load.strapForce;
+            eccentricTorque[i] = load.eccentricTorque;
+            peakRod = std::max(peakRod, std::fabs(load.rodForce));
+            peakStrap = std::max(peakStrap, std::fabs(load.strapForce));
+            sumSquares += load.strapForce * load.strapForce;
+        }
+        batch.peakRodForce[d] = peakRod;
+        batch.peakStrapForce[d] = peakStrap;
+        batch.rmsStrapForce[d] = (n > 0) ? std::sqrt(sumSquares / n) : T(0);
+    }
+    return batch;
+}
+
+/*!
+ * exahust bottlenecks of both sides of many designs (no grid needed, see SVE::exahustBottleneck)
+ * \param designs   engine parameters of each design
+ * \return one entry per design
+ */
+template <typename T>
+std::vector<SVE::ExahustBottlenecks<T>> SVE::exahustBottlenecks(const std::vector<s_engineParamsT<T>> &designs)
+{
+    std::vector<ExahustBottlenecks<T>> bottlenecks(designs.size());
+    for (size_t d=0; d<designs.size(); d++)
+        bottlenecks[d] = {{SVE::exahustBottleneck(designs[d], false), SVE::exahustBottleneck(designs[d], true)}};
+    return bottlenecks;
+}
+
+/*!
+ * cushion pressures of both ends of many designs, for screening sweep candidates (see SlideValveEngineT::cushionPressure)
+ * \param designs           engine parameters of each design
+ * \param exahustPressure   back pressure when the exahust closes (absolute)
+ * \param exponent          polytropic exponent of the compression
+ * \return one entry per design, NaN where the design geometry is invalid
+ */
+template <typename T>
+std::vector<std::array<T, 2>> SVE::cushionPressures(const std::vector<s_engineParamsT<T>> &designs, T exahustPressure, T exponent)
+{
+    std::vector<std::array<T, 2>> pressures(designs.size());
+    SlideValveEngineT<T> engine;
+    for (size_t d=0; d<designs.size(); d++){
+        if (engine.setEngineParams(designs[d]) == ErrorEnum::none)
+            pressures[d] = {{engine.cushionPressure(false, exahustPressure, exponent), engine.cushionPressure(true, exahustPressure, exponent)}};
+        else
+            pressures[d].fill(std::numeric_limits<T>::quiet_NaN());
+    }
+    return pressures;
+}
+
+/*!
+ * evaluates a figure of merit over a grid of two design dimensions, every other dimension is taken from <base>
+ * every grid point is evaluated (no refinement, see DesignSweep for that), and nothing is allocated, so <out> can be caller owned memory
+ * \param base          design the grid is centered on
+ * \param xDimension    first swept dimension
+ * \param xValues       <xCount> values of the first dimension
+ * \param yDimension    second swept dimension
+ * \param yValues       <yCount> values of the second dimension
+ * \param metric        figure to calculate, see SlideValveEngineT::metric
+ * \param ret           if true gives the value for the return stroke
+ * \param out           xCount * yCount results, x major. NaN where the design geometry is invalid
+ */
+template <typename T>
+void SVE::metricGrid(const s_designDimsT<T> &base, T s_designDimsT<T>::*xDimension, const T *xValues, int xCount,
+                     T s_designDimsT<T>::*yDimension, const T *yValues, int yCount, MetricEnum metric, bool ret, T *out)
+{
+    SlideValveEngineT<T> engine;
+    s_designDimsT<T> dims = base;
+    for (int x=0; x<xCount; x++){
+        dims.*xDimension = xValues[x];
+        for (int y=0; y<yCount; y++){
+            dims.*yDimension = yValues[y];
+            if (engine.setEngineParams(SVE::designParams(dims)) == ErrorEnum::none)
+                out[x * yCount + y] = engine.metric(metric, ret);
+            else
+                out[x * yCount + y] = std::numeric_limits<T>::quiet_NaN();
+        }
+    }
+}
+
+template class SVE::AngleGrid<float>;
+template class SVE::AngleGrid<double>;
+template class SVE::AngleGrid<long double>;
+template SVE::DesignBatch<float> SVE::evaluateBatch(const AngleGrid<float> &, const std::vector<s_engineParamsT<float>> &);
+template SVE::DesignBatch<double> SVE::evaluateBatch(const AngleGrid<double> &, const std::vector<s_engineParamsT<double>> &);
+template SVE::DesignBatch<long double> SVE::evaluateBatch(const AngleGrid<long double> &, const std::vector<s_engineParamsT<long double>> &);
+template SVE::ValveLoadBatch<float> SVE::valveLoads(const AngleGrid<float> &, const std::vector<s_engineParamsT<float>> &, const s_valveLoadSettingsT<float> &);
+template SVE::ValveLoadBatch<double> SVE::valveLoads(const AngleGrid<double> &, const std::vector<s_engineParamsT<double>> &, const s_valveLoadSettingsT<double> &);
+template SVE::ValveLoadBatch<long double> SVE::valveLoads(const AngleGrid<long double> &, const std::vector<s_engineParamsT<long double>> &, const s_valveLoadSettingsT<long double> &);
+template std::vector<SVE::ExahustBottlenecks<float>> SVE::exahustBottlenecks(const std::vector<s_engineParamsT<float>> &);
+template std::vector<SVE::ExahustBottlenecks<double>> SVE::exahustBottlenecks(const std::vector<s_engineParamsT<double>> &);
+template std::vector<SVE::ExahustBottlenecks<long double>> SVE::exahustBottlenecks(const std::vector<s_engineParamsT<long double>> &);
+template std::vector<std::array<float, 2>> SVE::cushionPressures(const std::vector<s_engineParamsT<float>> &, float, float);
+template std::vector<std::array<double, 2>> SVE::cushionPressures(const std::vector<s_engineParamsT<double>> &, double, double);
+template std::vector<std::array<long double, 2>> SVE::cushionPressures(const std::vector<s_engineParamsT<long double>> &, long double, long double);
+template void SVE::metricGrid(const s_designDimsT<float> &, float s_designDimsT<float>::*, const float *, int, float s_designDimsT<float>::*, const float *, int, MetricEnum, bool, float *);
+template void SVE::metricGrid(const s_designDimsT<double> &, double s_designDimsT<double>::*, const double *, int, double s_designDimsT<double>::*, const double *, int, MetricEnum, bool, double *);
+template void SVE::metricGrid(const s_designDimsT<long double> &, long double s_designDimsT<long double>::*, const long double *, int, long double s_designDimsT<long double>::*, const long double *, int, MetricEnum, bool, long double *);
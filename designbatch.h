@@ -0,0 +1,81 @@
+#ifndef DESIGNBATCH_H
+#define DESIGNBATCH_H
+
+#include <vector>
+#include "slidevalveengine.h"
+
+namespace SVE {
+    /*!
+     * crank angles shared by a batch of designs, with their cos and sin computed once
+     */
+    template <typename T>
+    class AngleGrid
+    {
+    public:
+        AngleGrid(T start, T stop, int steps);          // steps + 1 evenly spaced angles from start to stop (degrees)
+
+        int size() const;
+        const std::vector<T> &degrees() const;
+        const std::vector<T> &cos() const;
+        const std::vector<T> &sin() const;
+
+    private:
+        std::vector<T> _degrees;
+        std::vector<T> _cos;
+        std::vector<T> _sin;
+    };
+
+    /*!
+     * piston and valve positions of many designs on one angle grid, design major: stroke[design * grid.size() + i]
+     */
+    template <typename T>
+    struct DesignBatch
+    {
+        int gridSize;
+        std::vector<T> stroke;          // same as SlideValveEngine::crank2Stroke
+        std::vector<T> valvePos;        // same as SlideValveEngine::crank2ValvePos
+        std::vector<T> topExahust;      // exahust flow width of the top side, same as SlideValveEngine::exahustFlow(deg, false).width
+        std::vector<T> botExahust;      // exahust flow width of the bottom side
+    };
+
+    /*!
+     * valve gear loads of many designs on one angle grid, design major like DesignBatch, plus per design peaks over the grid
+     */
+    template <typename T>
+    struct ValveLoadBatch
+    {
+        int gridSize;
+        std::vector<T> rodForce;        // same as SlideValveEngine::valveLoad(deg, settings).rodForce
+        std::vector<T> strapForce;      // force along the eccentric rod
+        std::vector<T> eccentricTorque; // torque taken from the crankshaft
+        std::vector<T> peakRodForce;    // largest |rodForce| of each design
+        std::vector<T> peakStrapForce;  // largest |strapForce| of each design
+        std::vector<T> rmsStrapForce;   // RMS strapForce of each design, for wear comparisons
+    };
+
+    // exahust bottlenecks of one design, [0] top side, [1] bottom side
+    template <typename T>
+    using ExahustBottlenecks = std::array<s_exahustBottleneckT<T>, 2>;
+
+    template <typename T>
+    DesignBatch<T> evaluateBatch(const AngleGrid<T> &grid, const std::vector<s_engineParamsT<T>> &designs);
+
+    template <typename T>
+    ValveLoadBatch<T> valveLoads(const AngleGrid<T> &grid, const std::vector<s_engineParamsT<T>> &designs, const s_valveLoadSettingsT<T> &settings);
+
+    template <typename T>
+    std::vector<ExahustBottlenecks<T>> exahustBottlenecks(const std::vector<s_engineParamsT<T>> &designs);     // for screening large candidate sets
+
+    template <typename T>
+    std::vector<std::array<T, 2>> cushionPressures(const std::vector<s_engineParamsT<T>> &designs, T exahustPressure, T exponent);   // [0] top end, [1] bottom end, NaN for invalid designs
+
+    template <typename T>
+    void metricGrid(const s_designDimsT<T> &base, T s_designDimsT<T>::*xDimension, const T *xValues, int xCount,
+                    T s_designDimsT<T>::*yDimension, const T *yValues, int yCount, MetricEnum metric, bool ret, T *out);   // out[x * yCount + y], NaN for invalid designs
+
+    extern template class AngleGrid<float>;
+    extern template class AngleGrid<double>;
+    extern template class AngleGrid<long double>;
+}
+
+#endif // DESIGNBATCH_H
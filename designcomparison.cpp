@@ -0,0 +1,113 @@
+#include "designcomparison.h"
+#include "designbatch.h"
+#include "tracing.h"
+
+DesignComparison::DesignComparison()
+{
+    _crankStart = -180;
+    _crankStop = 440;
+}
+
+/*!
+ * replaces the compared designs and evaluates their curves
+ * \param designs       designs to compare
+ * \param crankStart    first crank angle of the curves
+ * \param crankStop     last crank angle of the curves
+ * \param steps         number of grid steps between crankStart and crankStop
+ */
+void DesignComparison::setDesigns(const QVector<DesignFile::Design> &designs, double crankStart, double crankStop, int steps)
+{
+    TRACE_SCOPE("DesignComparison::setDesigns");
+    _designs.clear();
+    _crankStart = crankStart;
+    _crankStop = crankStop;
+
+    // check each design, only the valid ones go in the batch
+    std::vector<s_engineParams> batchParams;
+    for (int i=0; i<designs.size(); i++){
+        Design design;
+        design.name = designs[i].name;
+        design.dims = designs[i].dims;
+        design.color = QColor::fromHsv((360 * i) / qMax(designs.size(), 1), 220, 200);
+        design.shaded = false;
+
+        SlideValveEngine engine;
+        design.valid = engine.setEngineParams(SVE::designParams(design.dims)) == ErrorEnum::none;
+        design.criticalPoints = engine.criticalPoints();
+        if (design.valid)
+            batchParams.push_back(SVE::designParams(design.dims));
+        _designs.append(design);
+    }
+
+    SVE::AngleGrid<double> grid(crankStart, crankStop, steps);
+    SVE::DesignBatch<double> batch = SVE::evaluateBatch(grid, batchParams);
+
+    int batchIndex = 0;
+    for (Design &design : _designs){
+        if (!design.valid)
+            continue;
+        const double *stroke = batch.stroke.data() + batchIndex * batch.gridSize;
+        const double *valvePos = batch.valvePos.data() + batchIndex * batch.gridSize;
+        batchIndex++;
+
+        QVector<QCPGraphData> strokeData(batch.gridSize);
+        QVector<QCPGraphData> valveData(batch.gridSize);
+        for (int i=0; i<batch.gridSize; i++){
+            strokeData[i] = QCPGraphData(grid.degrees()[i], stroke[i]);
+            valveData[i] = QCPGraphData(grid.degrees()[i], valvePos[i]);
+        }
+        design.stroke = QSharedPointer<QCPGraphDataContainer>::create();
+        design.stroke->set(strokeData, true);
+        design.valvePos = QSharedPointer<QCPGraphDataContainer>::create();
+        design.valvePos->set(valveData, true);
+
+        // every repeat of each critical point within the crank range
+        QVector<QCPGraphData> eventData;
+        for (double point : design.criticalPoints){
+            for (double deg = point - 360; deg <= crankStop; deg += 360){
+                if (deg >= crankStart)
+                    eventData.append(QCPGraphData(deg, SVE::crank2Stroke(deg, design.dims.stroke, design.dims.conRod)));
+            }
+        }
+        design.events = QSharedPointer<QCPGraphDataContainer>::create();
+        design.events->set(eventData);
+    }
+}
+
+void DesignComparison::clear()
+{
+    _designs.clear();
+}
+
+bool DesignComparison::isEmpty() const
+{
+    return _designs.isEmpty();
+}
+
+int DesignComparison::size() const
+{
+    return _designs.size();
+}
+
+const DesignComparison::Design &DesignComparison::design(int i) const
+{
+    return _designs[i];
+}
+
+/*!
+ * turns the region shading of a design on or off
+ * \param i             design index
+ * \param shaded        true to shade
+ * \param resolution    resolution to sample the shading at, if it has not been generated yet
+ */
+void DesignComparison::setShaded(int i, bool shaded, const SVE::SampleResolution<double> &resolution)
+{
+    Design &design = _designs[i];
+    design.shaded = shaded && design.valid;
+    if (design.shaded && design.regions.isEmpty()){
+        SlideValveEngine engine;
+        engine.setEngineParams(SVE::designParams(design.dims));
+        engine.prepareTables();
+        design.regions = CycleDiagram::segments(engine, _crankStart, _crankStop, resolution);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef DESIGNCOMPARISON_H
+#define DESIGNCOMPARISON_H
+
+#include <array>
+#include <QColor>
+#include "qcustomplot.h"
+#include "cyclediagram.h"
+#include "designfile.h"
+
+/*!
+ * A set of designs overlaid on the cycle diagram for comparison. The piston and valve curves of all designs are
+ * evaluated together on one crank angle grid (SVE::evaluateBatch) when the designs are set, and kept in shared
+ * data containers so redrawing the overlay does not copy or recalculate them.
+ */
+class DesignComparison
+{
+public:
+    struct Design
+    {
+        QString name;
+        s_designDims dims;
+        bool valid;                                             // false if the engine rejects the design (it has no curves)
+        QColor color;
+        bool shaded;                                            // draw the cycle region shading of this design
+        std::array<double, 8> criticalPoints;
+        QSharedPointer<QCPGraphDataContainer> stroke;           // piston position on the shared grid
+        QSharedPointer<QCPGraphDataContainer> valvePos;         // valve position on the shared grid
+        QSharedPointer<QCPGraphDataContainer> events;           // critical points on the piston curve
+        QVector<CycleDiagram::Segment> regions;                 // shading, generated the first time the design is shaded
+    };
+
+    DesignComparison();
+
+    void setDesigns(const QVector<DesignFile::Design> &designs, double crankStart, double crankStop, int steps);
+    void clear();
+    bool isEmpty() const;
+    int size() const;
+    const Design &design(int i) const;
+    void setShaded(int i, bool shaded, const SVE::SampleResolution<double> &resolution);
+
+private:
+    QVector<Design> _designs;
+    double _crankStart;
+    double _crankStop;
+};
+
+#endif // DESIGNCOMPARISON_H
@@ -0,0 +1,129 @@
+#include "designfile.h"
+#include <QFile>
+#include <QTextStream>
+
+namespace {
+    void setError(QString *error, const QString &message)
+    {
+        if (error)
+            *error = message;
+    }
+}
+
+QStringList DesignFile::columns()
+{
+    QStringList names{"name"};
+    for (const Dimension &dimension : dimensions())
+        names << dimension.name;
+    return names;
+}
+
+const QVector<DesignFile::Dimension> &DesignFile::dimensions()
+{
+    // the clearances only became dimensions later, see read()
+    static const QVector<Dimension> dims = [] {
+        QVector<Dimension> list;
+        for (const s_designDimension &dimension : SVE::designDimensions){
+            bool optional = dimension.member == &s_designDims::topClearance || dimension.member == &s_designDims::bottomClearance;
+            list.append(Dimension{QString::fromLatin1(dimension.name), dimension.member, optional});
+        }
+        return list;
+    }();
+    return dims;
+}
+
+/*!
+ * reads designs from a CSV file
+ * \param fileName  file to read
+ * \param designs   designs read are appended here
+ * \param error     set to a description of the problem if reading fails
+ * \return true if the whole file was read
+ */
+bool DesignFile::read(const QString &fileName, QVector<Design> &designs, QString *error)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)){
+        setError(error, file.errorString());
+        return false;
+    }
+    QTextStream in(&file);
+
+    // map the header names to column numbers
+    QStringList header = in.readLine().split(',');
+    for (QString &name : header)
+        name = name.trimmed();
+    int nameColumn = header.indexOf("name");
+    const QVector<Dimension> &dims = dimensions();
+    QVector<int> dimColumn;
+    for (const Dimension &dimension : dims){
+        dimColumn.append(header.indexOf(dimension.name));
+        if (dimColumn.last() == -1 && !dimension.optional){
+            setError(error, QString("missing column %1").arg(dimension.name));
+            return false;
+        }
+    }
+
+    int lineNumber = 1;
+    while (!in.atEnd()){
+        QString line = in.readLine();
+        lineNumber++;
+        if (line.trimmed().isEmpty())
+            continue;
+        QStringList fields = line.split(',');
+        if (fields.size() < header.size()){
+            setError(error, QString("line %1: expected %2 fields").arg(lineNumber).arg(header.size()));
+            return false;
+        }
+
+        Design design;
+        design.name = (nameColumn == -1) ? QString("design %1").arg(designs.size() + 1) : fields[nameColumn].trimmed();
+        for (int i=0; i<dimColumn.size(); i++){
+            if (dimColumn[i] == -1)
+                continue;
+            bool ok;
+            design.dims.*(dims[i].member) = fields[dimColumn[i]].trimmed().toDouble(&ok);
+            if (!ok){
+                setError(error, QString("line %1: %2 is not a number").arg(lineNumber).arg(dims[i].name));
+                return false;
+            }
+        }
+        // clearance only became a dimension later, older files get 8% of the swept volume
+        double clearance = 0.08 * SVE::pi<double>() * design.dims.bore * design.dims.bore / 4 * design.dims.stroke;
+        for (int i=0; i<dimColumn.size(); i++)
+            if (dimColumn[i] == -1)
+                design.dims.*(dims[i].member) = clearance;
+        designs.append(design);
+    }
+    return true;
+}
+
+/*!
+ * writes designs to a CSV file, replacing it
+ * \param fileName  file to write
+ * \param designs   designs to write
+ * \param error     set to a description of the problem if writing fails
+ * \return true if the file was written
+ */
+bool DesignFile::write(const QString &fileName, const QVector<Design> &designs, QString *error)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)){
+        setError(error, file.errorString());
+        return false;
+    }
+    QTextStream out(&file);
+    out << columns().join(',') << '\n';
+    for (const Design &design : designs){
+        // commas would split the name into two fields
+        out << QString(design.name).replace(',', ' ');
+        for (const Dimension &dimension : dimensions())
+            out << ',' << QString::number(design.dims.*(dimension.member), 'g', 17);
+        out << '\n';
+    }
+    out.flush();
+    if (out.status() != QTextStream::Ok){
+        setError(error, file.errorString());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#ifndef DESIGNFILE_H
+#define DESIGNFILE_H
+
+#include <QString>
+#include <QVector>
+#include "slidevalveengine.h"
+
+/*!
+ * Reads and writes lists of named designs as CSV, one design per row:
+ *     name,bore,stroke,conRod,valveTravel,valveConRod,eccentricAdvance,steamPortWidth,steamPortSpace,exahustPortWidth,valveWidth,valveTopLand,valveBottomLand,topClearance,bottomClearance
+ * The header row is required, so columns can be in any order. Files without the clearance columns (written before clearance
+ * was a dimension) get the default clearance of 8% of the swept volume.
+ */
+class DesignFile
+{
+public:
+    struct Design
+    {
+        QString name;
+        s_designDims dims;
+    };
+
+    // one dimension column
+    struct Dimension
+    {
+        QString name;
+        double s_designDims::*member;
+        bool optional;                  // may be missing from a file, see read()
+    };
+
+    static bool read(const QString &fileName, QVector<Design> &designs, QString *error = nullptr);
+    static bool write(const QString &fileName, const QVector<Design> &designs, QString *error = nullptr);
+    static QStringList columns();                           // column names, in the order written
+    static const QVector<Dimension> &dimensions();          // the dimension columns (all but name), in the order written
+};
+
+#endif // DESIGNFILE_H
@@ -0,0 +1,109 @@
+#include "designhistory.h"
+
+DesignHistory::DesignHistory(int maxEntries)
+{
+    _current = -1;
+    _maxEntries = maxEntries;
+}
+
+/*!
+ * adds a design after the current entry. Entries after the current one (undone changes) are dropped, and the oldest entry
+ * is dropped when the history is full.
+ * \param entry     new design. If it has no curves and the cycle diagram is the same as the current entry, it shares the current curves
+ */
+void DesignHistory::push(const Entry &entry)
+{
+    _entries.erase(_entries.begin() + (_current + 1), _entries.end());
+
+    Entry newEntry = entry;
+    if (!newEntry.cycleCurves && !_entries.empty() && sameCycleDiagram(_entries.back(), newEntry)){
+        newEntry.cycleCurves = _entries.back().cycleCurves;
+        newEntry.cycleResolution = _entries.back().cycleResolution;
+    }
+    _entries.push_back(newEntry);
+
+    if (static_cast<int>(_entries.size()) > _maxEntries)
+        _entries.pop_front();
+    _current = static_cast<int>(_entries.size()) - 1;
+}
+
+bool DesignHistory::isEmpty() const
+{
+    return _entries.empty();
+}
+
+int DesignHistory::size() const
+{
+    return static_cast<int>(_entries.size());
+}
+
+bool DesignHistory::canUndo() const
+{
+    return _current > 0;
+}
+
+bool DesignHistory::canRedo() const
+{
+    return _current + 1 < static_cast<int>(_entries.size());
+}
+
+/*!
+ * steps back one entry. Only call if canUndo()
+ * \return the new current entry
+ */
+const DesignHistory::Entry &DesignHistory::undo()
+{
+    if (canUndo())
+        _current--;
+    return _entries[_current];
+}
+
+/*!
+ * steps forward one entry. Only call if canRedo()
+ * \return the new current entry
+ */
+const DesignHistory::Entry &DesignHistory::redo()
+{
+    if (canRedo())
+        _current++;
+    return _entries[_current];
+}
+
+const DesignHistory::Entry &DesignHistory::current() const
+{
+    return _entries[_current];
+}
+
+/*!
+ * \param resolution    resolution the curves are needed for
+ * \return the cached cycle diagram curves of the current entry, or null if there are none for <resolution>
+ */
+DesignHistory::CycleCurves DesignHistory::cycleCurves(const SVE::SampleResolution<double> &resolution) const
+{
+    if (isEmpty() || !current().cycleCurves || !sameResolution(current().cycleResolution, resolution))
+        return CycleCurves();
+    return current().cycleCurves;
+}
+
+/*!
+ * caches the cycle diagram curves of the current entry
+ */
+void DesignHistory::setCycleCurves(CycleCurves curves, const SVE::SampleResolution<double> &resolution)
+{
+    if (isEmpty())
+        return;
+    _entries[_current].cycleCurves = curves;
+    _entries[_current].cycleResolution = resolution;
+}
+
+// the cycle diagram only depends on the piston motion and the critical points
+bool DesignHistory::sameCycleDiagram(const Entry &a, const Entry &b)
+{
+    return a.dims.stroke == b.dims.stroke && a.dims.conRod == b.dims.conRod && a.criticalPoints == b.criticalPoints;
+}
+
+bool DesignHistory::sameResolution(const SVE::SampleResolution<double> &a, const SVE::SampleResolution<double> &b)
+{
+    return a.viewLower == b.viewLower && a.viewUpper == b.viewUpper && a.viewXScale == b.viewXScale && a.viewYScale == b.viewYScale
+            && a.xScale == b.xScale && a.yScale == b.yScale && a.tolerance == b.tolerance;
+}
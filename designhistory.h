@@ -0,0 +1,51 @@
+#ifndef DESIGNHISTORY_H
+#define DESIGNHISTORY_H
+
+#include <deque>
+#include <memory>
+#include "slidevalveengine.h"
+#include "cyclediagram.h"
+
+/*!
+ * Undo/redo history of accepted designs. Each entry keeps what is needed to redisplay it without recalculating:
+ * the critical points and the sampled cycle diagram curves. Curves are shared between neighbouring entries when a change
+ * does not affect the cycle diagram (e.g. bore), so a long history of small tweaks stays small.
+ * Undo and redo only move the current index, so they are constant time.
+ */
+class DesignHistory
+{
+public:
+    typedef std::shared_ptr<const QVector<CycleDiagram::Segment>> CycleCurves;
+
+    struct Entry
+    {
+        s_designDims dims;                                  // design as entered
+        std::array<double, 8> criticalPoints;               // SlideValveEngine::criticalPoints() of the design
+        CycleCurves cycleCurves;                            // cycle diagram curves, null until drawn
+        SVE::SampleResolution<double> cycleResolution;      // resolution the curves were sampled for
+    };
+
+    explicit DesignHistory(int maxEntries = 1000);
+
+    void push(const Entry &entry);                      // makes <entry> current, dropping the entries that could be redone
+    bool isEmpty() const;
+    int size() const;
+    bool canUndo() const;
+    bool canRedo() const;
+    const Entry &undo();                                // steps back and returns the new current entry
+    const Entry &redo();
+    const Entry &current() const;
+
+    CycleCurves cycleCurves(const SVE::SampleResolution<double> &resolution) const;    // curves of the current entry if cached for <resolution>, else null
+    void setCycleCurves(CycleCurves curves, const SVE::SampleResolution<double> &resolution);
+
+private:
+    std::deque<Entry> _entries;
+    int _current;                                       // index of the current entry, -1 if empty
+    int _maxEntries;
+
+    static bool sameCycleDiagram(const Entry &a, const Entry &b);
+    static bool sameResolution(const SVE::SampleResolution<double> &a, const SVE::SampleResolution<double> &b);
+};
+
+#endif // DESIGNHISTORY_H
@@ -0,0 +1,119 @@
+#include "designindex.h"
+#include <limits>
+
+/*!
+ * indexes a set of designs, replacing any previous ones
+ * \param designs   designs to index, usually read with DesignFile::read() or from DesignSweep::designs()
+ */
+void DesignIndex::build(const QVector<DesignFile::Design> &designs)
+{
+    clear();
+    SlideValveEngine engine;
+    for (const DesignFile::Design &design : designs){
+        if (engine.setEngineParams(SVE::designParams(design.dims)) != ErrorEnum::none)
+            continue;
+        _designs.append(design);
+        _criticalPoints.push_back(engine.criticalPoints());
+    }
+
+    // spread of each dimension, dimensions that do not change are left unscaled
+    for (int k=0; k<dimensionCount; k++){
+        double low = std::numeric_limits<double>::infinity();
+        double high = -std::numeric_limits<double>::infinity();
+        for (const DesignFile::Design &design : _designs){
+            low = qMin(low, design.dims.*(SVE::designDimensions[k].member));
+            high = qMax(high, design.dims.*(SVE::designDimensions[k].member));
+        }
+        _scale[k] = (high > low) ? 1 / (high - low) : 1;
+    }
+
+    std::vector<std::array<double, dimensionCount>> points;
+    points.reserve(_designs.size());
+    for (const DesignFile::Design &design : _designs)
+        points.push_back(normalized(design.dims));
+    _dimsTree.build(points);
+    _criticalTree.build(_criticalPoints);
+}
+
+void DesignIndex::clear()
+{
+    _designs.clear();
+    _criticalPoints.clear();
+    _scale.fill(1);
+    _dimsTree.build({});
+    _criticalTree.build({});
+}
+
+int DesignIndex::size() const
+{
+    return _designs.size();
+}
+
+const DesignFile::Design &DesignIndex::design(int i) const
+{
+    return _designs[i];
+}
+
+std::array<double, 8> DesignIndex::criticalPoints(int i) const
+{
+    return _criticalPoints[i];
+}
+
+/*!
+ * finds the indexed design closest to <dims>
+ * \param dims      design to look up, for example the current spin box values
+ * \param distance  if not null, set to the normalized distance (1 = the full spread of one dimension)
+ * \return index of the closest design, -1 if the index is empty
+ */
+int DesignIndex::nearest(const s_designDims &dims, double *distance) const
+{
+    std::array<double, dimensionCount> ones;
+    ones.fill(1);
+    return _dimsTree.nearest(normalized(dims), ones, distance);
+}
+
+/*!
+ * finds the designs with one critical point inside an angle window, for example the cutoff within 1 degree of the current cutoff
+ * \param point     index of the critical point, same order as SlideValveEngine::criticalPoints() (1 = top cutoff)
+ * \param deg       center of the window, crank degrees
+ * \param tolerance half width of the window, degrees
+ * \return indices of the designs found
+ */
+QVector<int> DesignIndex::criticalPointWindow(int point, double deg, double tolerance) const
+{
+    std::array<double, 8> lower;
+    std::array<double, 8> upper;
+    lower.fill(-std::numeric_limits<double>::infinity());
+    upper.fill(std::numeric_limits<double>::infinity());
+
+    // critical points are kept between 0 and 360, so a window across 0 is searched as two boxes
+    std::vector<int> found;
+    double low = SVE::addAngles(deg, -tolerance);
+    double high = SVE::addAngles(deg, tolerance);
+    if (tolerance >= 180){
+        _criticalTree.range(lower, upper, found);
+    }else if (low <= high){
+        lower[point] = low;
+        upper[point] = high;
+        _criticalTree.range(lower, upper, found);
+    }else{
+        lower[point] = low;
+        _criticalTree.range(lower, upper, found);
+        lower[point] = -std::numeric_limits<double>::infinity();
+        upper[point] = high;
+        _criticalTree.range(lower, upper, found);
+    }
+    QVector<int> designs;
+    designs.reserve(static_cast<int>(found.size()));
+    for (int i : found)
+        designs.append(i);
+    return designs;
+}
+
+std::array<double, DesignIndex::dimensionCount> DesignIndex::normalized(const s_designDims &dims) const
+{
+    std::array<double, dimensionCount> point;
+    for (int k=0; k<dimensionCount; k++)
+        point[k] = dims.*(SVE::designDimensions[k].member) * _scale[k];
+    return point;
+}
@@ -0,0 +1,40 @@
+#ifndef DESIGNINDEX_H
+#define DESIGNINDEX_H
+
+#include <QVector>
+#include <iterator>
+#include "designfile.h"
+#include "kdtree.h"
+
+/*!
+ * Index of known designs (a stored sweep or design file) for lookups while the user edits, without re-evaluating anything.
+ * The critical points of every design are calculated once in build(), then k-d trees over the design dimensions and over the
+ * critical points answer nearest design and critical point window queries.
+ * Dimensions are normalized by their spread over the indexed designs, so nearest() weighs a change across the swept range of
+ * every dimension the same, whatever its units.
+ */
+class DesignIndex
+{
+public:
+    static constexpr int dimensionCount = static_cast<int>(std::size(SVE::designDimensions));
+
+    void build(const QVector<DesignFile::Design> &designs);     // designs with invalid geometry are left out
+    void clear();
+    int size() const;
+    const DesignFile::Design &design(int i) const;
+    std::array<double, 8> criticalPoints(int i) const;
+
+    int nearest(const s_designDims &dims, double *distance = nullptr) const;            // closest design, -1 if the index is empty
+    QVector<int> criticalPointWindow(int point, double deg, double tolerance) const;    // designs with critical point <point> within deg +- tolerance
+
+private:
+    QVector<DesignFile::Design> _designs;
+    std::vector<std::array<double, 8>> _criticalPoints;
+    std::array<double, dimensionCount> _scale;          // 1 / spread of each dimension
+    SVE::KdTree<double, dimensionCount> _dimsTree;      // normalized dimensions
+    SVE::KdTree<double, 8> _criticalTree;
+
+    std::array<double, dimensionCount> normalized(const s_designDims &dims) const;
+};
+
+#endif // DESIGNINDEX_H
@@ -0,0 +1,302 @@
+#include "designsweep.h"
+#include <QFile>
+#include <QTextStream>
+#include <QtConcurrent>
+#include "tracing.h"
+
+DesignSweep::DesignSweep(QObject *parent) :
+    QObject(parent)
+{
+    _size = 0;
+    _cancelled = false;
+    connect(&_watcher, SIGNAL(finished()), this, SIGNAL(finished()));
+}
+
+DesignSweep::~DesignSweep()
+{
+    cancel();
+    _watcher.waitForFinished();
+}
+
+/*!
+ * starts a new sweep in the global thread pool
+ * \param settings  what to sweep
+ */
+void DesignSweep::start(const Settings &settings)
+{
+    cancel();
+    _watcher.waitForFinished();
+
+    _settings = settings;
+    _size = (1 << settings.levels) + 1;
+    _values.fill(qQNaN(), _size * _size);
+    _evaluated.fill(false, _size * _size);
+    {
+        QMutexLocker lock(&_mutex);
+        _published = _values;
+    }
+    _cancelled = false;
+    _watcher.setFuture(QtConcurrent::run([this]{ run(); }));
+}
+
+bool DesignSweep::isRunning() const
+{
+    return _watcher.isRunning();
+}
+
+DesignSweep::Settings DesignSweep::settings() const
+{
+    return _settings;
+}
+
+int DesignSweep::gridSize() const
+{
+    return _size;
+}
+
+QVector<double> DesignSweep::values() const
+{
+    QMutexLocker lock(&_mutex);
+    return _published;
+}
+
+int DesignSweep::evaluatedCount() const
+{
+    // only read the worker's flags once it is done
+    if (isRunning())
+        return -1;
+    return static_cast<int>(std::count(_evaluated.begin(), _evaluated.end(), true));
+}
+
+void DesignSweep::cancel()
+{
+    _cancelled = true;
+}
+
+/*!
+ * the sweep. Each level is calculated in parallel, then published
+ */
+void DesignSweep::run()
+{
+    TRACE_SCOPE("DesignSweep::run");
+    const int levels = _settings.levels;
+    const int coarseLevels = qMin(4, levels);           // 16 x 16 cells to start
+    int cellSize = 1 << (levels - coarseLevels);
+
+    // points to calculate at each level, and the cells to consider for refinement
+    QVector<QPoint> points;
+    QVector<QPoint> cells;
+    for (int i=0; i<_size; i+=cellSize){
+        for (int j=0; j<_size; j+=cellSize){
+            points.append(QPoint(i, j));
+            if (i + cellSize < _size && j + cellSize < _size)
+                cells.append(QPoint(i, j));
+        }
+    }
+
+    double tolerance = 0;
+    for (int level=0; ; level++){
+        // publish() shares _values with the GUI copy, so detach here rather than from several workers at once
+        double *values = _values.data();
+        QtConcurrent::blockingMap(points, [this, values](const QPoint &p){
+            if (!_cancelled)
+                values[p.x() * _size + p.y()] = evaluate(p.x(), p.y());
+        });
+        if (_cancelled){
+            // the points of this level were marked when they were queued, but may not have been calculated
+            for (const QPoint &p : points)
+                _evaluated[p.x() * _size + p.y()] = false;
+            return;
+        }
+        for (const QPoint &p : points)
+            _evaluated[p.x() * _size + p.y()] = true;
+        for (const QPoint &cell : cells)
+            fillCell(cell.x(), cell.y(), cellSize);
+        publish(level);
+
+        if (cellSize == 1)
+            break;
+
+        // refine where the metric changes by more than 1% of its range across a cell
+        if (level == 0){
+            double lo = qInf();
+            double hi = -qInf();
+            for (double v : _values){
+                if (!qIsNaN(v)){
+                    lo = qMin(lo, v);
+                    hi = qMax(hi, v);
+                }
+            }
+            tolerance = (hi > lo) ? (hi - lo) / 100 : 0;
+        }
+
+        QVector<QPoint> refined;
+        for (const QPoint &cell : cells){
+            double corners[4] = {_values[cell.x() * _size + cell.y()], _values[(cell.x() + cellSize) * _size + cell.y()],
+                                 _values[cell.x() * _size + cell.y() + cellSize], _values[(cell.x() + cellSize) * _size + cell.y() + cellSize]};
+            int invalid = 0;
+            double lo = qInf();
+            double hi = -qInf();
+            for (double v : corners){
+                if (qIsNaN(v)){
+                    invalid++;
+                }else{
+                    lo = qMin(lo, v);
+                    hi = qMax(hi, v);
+                }
+            }
+            // all invalid cells are left alone, cells on the validity boundary are always refined
+            if (invalid == 4)
+                continue;
+            if (invalid > 0 || hi - lo > tolerance)
+                refined.append(cell);
+        }
+
+        // split each refined cell in four, calculating the new corners once
+        cellSize /= 2;
+        cells.clear();
+        points.clear();
+        for (const QPoint &cell : refined){
+            for (int a=0; a<2; a++){
+                for (int b=0; b<2; b++)
+                    cells.append(QPoint(cell.x() + a*cellSize, cell.y() + b*cellSize));
+            }
+            for (int a=0; a<=2; a++){
+                for (int b=0; b<=2; b++){
+                    int index = (cell.x() + a*cellSize) * _size + cell.y() + b*cellSize;
+                    if (!_evaluated[index]){
+                        _evaluated[index] = true;       // marked now so neighbouring cells don't add it again
+                        points.append(QPoint(cell.x() + a*cellSize, cell.y() + b*cellSize));
+                    }
+                }
+            }
+        }
+        if (cells.isEmpty())
+            break;
+    }
+}
+
+/*!
+ * calculates the metric at grid point (i, j)
+ * \return the metric, NaN if the engine rejects the design
+ */
+double DesignSweep::evaluate(int i, int j) const
+{
+    const QVector<DesignFile::Dimension> &dims = DesignFile::dimensions();
+    s_designDims design = _settings.base;
+    design.*(dims[_settings.xDimension].member) = _settings.xRange.lower + _settings.xRange.size() * i / (_size - 1);
+    design.*(dims[_settings.yDimension].member) = _settings.yRange.lower + _settings.yRange.size() * j / (_size - 1);
+
+    // one engine per pool thread. No kinematic tables are prepared: a metric needs only a few positions, which are cheaper
+    // to calculate directly than a table for every new stroke or valve travel value
+    thread_local SlideValveEngine engine;
+    if (engine.setEngineParams(SVE::designParams(design)) != ErrorEnum::none)
+        return qQNaN();
+    return engine.metric(_settings.metric, _settings.ret);
+}
+
+/*!
+ * fills the points inside a cell that have not been calculated, by bilinear interpolation of the corners
+ * (or the nearest corner if some corners are invalid)
+ */
+void DesignSweep::fillCell(int i, int j, int size)
+{
+    double c00 = _values[i * _size + j];
+    double c10 = _values[(i + size) * _size + j];
+    double c01 = _values[i * _size + j + size];
+    double c11 = _values[(i + size) * _size + j + size];
+    bool allValid = !qIsNaN(c00) && !qIsNaN(c10) && !qIsNaN(c01) && !qIsNaN(c11);
+
+    for (int a=0; a<=size; a++){
+        for (int b=0; b<=size; b++){
+            int index = (i + a) * _size + j + b;
+            if (_evaluated[index])
+                continue;
+            double u = double(a) / size;
+            double v = double(b) / size;
+            if (allValid)
+                _values[index] = (1-u)*(1-v)*c00 + u*(1-v)*c10 + (1-u)*v*c01 + u*v*c11;
+            else
+                _values[index] = (u < 0.5) ? ((v < 0.5) ? c00 : c01) : ((v < 0.5) ? c10 : c11);
+        }
+    }
+}
+
+void DesignSweep::publish(int level)
+{
+    {
+        QMutexLocker lock(&_mutex);
+        _published = _values;
+    }
+    emit levelFinished(level, _settings.levels);
+}
+
+/*!
+ * writes the calculated points (not the interpolated ones) as CSV: x dimension, y dimension, metric
+ * \param fileName  file to write
+ * \param error     set to a description of the problem if writing fails
+ * \return true if the file was written
+ */
+bool DesignSweep::writeCsv(const QString &fileName, QString *error) const
+{
+    if (isRunning()){
+        if (error)
+            *error = "the sweep is still running";
+        return false;
+    }
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)){
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    const QVector<DesignFile::Dimension> &dims = DesignFile::dimensions();
+    QTextStream out(&file);
+    out << dims[_settings.xDimension].name << ',' << dims[_settings.yDimension].name << ",metric\n";
+    for (int i=0; i<_size; i++){
+        for (int j=0; j<_size; j++){
+            int index = i * _size + j;
+            if (!_evaluated[index] || qIsNaN(_values[index]))
+                continue;
+            out << QString::number(_settings.xRange.lower + _settings.xRange.size() * i / (_size - 1), 'g', 12) << ','
+                << QString::number(_settings.yRange.lower + _settings.yRange.size() * j / (_size - 1), 'g', 12) << ','
+                << QString::number(_values[index], 'g', 12) << '\n';
+        }
+    }
+    return out.status() == QTextStream::Ok;
+}
+
+/*!
+ * the designs of the calculated points (not the interpolated ones), named by their swept dimensions
+ * \param values    if not null, set to the metric of each design
+ */
+QVector<DesignFile::Design> DesignSweep::designs(QVector<double> *values) const
+{
+    QVector<DesignFile::Design> designs;
+    if (values)
+        values->clear();
+    if (isRunning())
+        return designs;
+
+    const QVector<DesignFile::Dimension> &dims = DesignFile::dimensions();
+    const DesignFile::Dimension &x = dims[_settings.xDimension];
+    const DesignFile::Dimension &y = dims[_settings.yDimension];
+    for (int i=0; i<_size; i++){
+        for (int j=0; j<_size; j++){
+            int index = i * _size + j;
+            if (!_evaluated[index] || qIsNaN(_values[index]))
+                continue;
+            DesignFile::Design design;
+            design.dims = _settings.base;
+            design.dims.*(x.member) = _settings.xRange.lower + _settings.xRange.size() * i / (_size - 1);
+            design.dims.*(y.member) = _settings.yRange.lower + _settings.yRange.size() * j / (_size - 1);
+            design.name = QString("%1=%2 %3=%4").arg(x.name).arg(design.dims.*(x.member), 0, 'g', 6)
+                                                .arg(y.name).arg(design.dims.*(y.member), 0, 'g', 6);
+            designs.append(design);
+            if (values)
+                values->append(_values[index]);
+        }
+    }
+    return designs;
+}
@@ -0,0 +1,73 @@
+#ifndef DESIGNSWEEP_H
+#define DESIGNSWEEP_H
+
+#include <atomic>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QObject>
+#include "qcustomplot.h"
+#include "designfile.h"
+
+/*!
+ * Sweeps a design metric over two design dimensions in the background, for the design space heatmap.
+ * The grid is filled progressively: a coarse grid first, then each level halves the cell size, but only in cells where the
+ * metric changes quickly or the design becomes invalid (quadtree refinement). Cells that are not refined are filled by
+ * interpolation, so values() always covers the whole grid.
+ * Usage:
+ *     DesignSweep *sweep = new DesignSweep(this);
+ *     connect(sweep, SIGNAL(levelFinished(int, int)), ...);      // read values() and redraw
+ *     sweep->start(settings);
+ */
+class DesignSweep : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Settings
+    {
+        s_designDims base;              // design the swept dimensions are varied from
+        int xDimension;                 // index into DesignFile::dimensions()
+        int yDimension;
+        QCPRange xRange;
+        QCPRange yRange;
+        MetricEnum metric;
+        bool ret;                       // metric for the return stroke (bottom side)
+        int levels;                     // the final grid has 2^levels cells on each side
+    };
+
+    explicit DesignSweep(QObject *parent = nullptr);
+    ~DesignSweep();
+
+    void start(const Settings &settings);               // cancels any sweep in progress, returns immediately
+    bool isRunning() const;
+    Settings settings() const;
+    int gridSize() const;                               // points on each side of the grid (2^levels + 1)
+    QVector<double> values() const;                     // current grid, x major: values[x * gridSize() + y]. NaN where the design is invalid
+    int evaluatedCount() const;                         // points actually calculated (not interpolated)
+    bool writeCsv(const QString &fileName, QString *error = nullptr) const;     // writes the calculated points
+    QVector<DesignFile::Design> designs(QVector<double> *values = nullptr) const;     // the calculated valid points as full designs (and their metric), empty while running
+
+public slots:
+    void cancel();
+
+signals:
+    void levelFinished(int level, int levels);          // values() has been updated, emitted from the worker thread
+    void finished();
+
+private:
+    Settings _settings;
+    int _size;
+    QVector<double> _values;                            // calculated or interpolated values, owned by the worker while running
+    QVector<char> _evaluated;                           // true where _values was calculated
+    QVector<double> _published;                         // copy of _values for the GUI, guarded by _mutex
+    mutable QMutex _mutex;
+    std::atomic<bool> _cancelled;
+    QFutureWatcher<void> _watcher;
+
+    void run();
+    double evaluate(int i, int j) const;
+    void fillCell(int i, int j, int size);
+    void publish(int level);
+};
+
+#endif // DESIGNSWEEP_H
@@ -0,0 +1,247 @@
+#include "dynamicsimulation.h"
+#include <limits>
+
+SVE::DynamicSimulation::DynamicSimulation()
+{
+    _tableSettings = defaultSettings();
+    _area = 0;
+    _indicatedWork = 0;
+    std::fill(_torque, _torque + tableSteps + 1, 0.0);
+}
+
+/*!
+ * settings for the default engine (psi, inches, lbf in s^2) starting from rest against a fan like load, settling near 200 rpm
+ */
+SVE::DynamicSimulation::Settings SVE::DynamicSimulation::defaultSettings()
+{
+    Settings settings;
+    settings.supplyPressure = 114.7;
+    settings.exahustPressure = 14.7;
+    settings.polytropicExponent = 1.13;
+    settings.inertia = 500.0;
+    settings.loadTorque = 2000.0;
+    settings.viscousLoad = 0.0;
+    settings.fanLoad = 15.0;
+    settings.initialSpeed = 0.0;
+    settings.initialCrank = 30.0;
+    settings.timeStep = 1e-3;
+    settings.angleStep = 0.5;
+    settings.revolutions = 200;
+    settings.maxTime = 60.0;
+    settings.measureRevolutions = 10;
+    settings.traceInterval = 0;
+    return settings;
+}
+
+/*!
+ * sets the engine geometry and tabulates the steam torque over one revolution
+ * \param params    engine geometry
+ * \param settings  pressures and polytropic exponent used for the indicator cycle (the other fields are not used)
+ * \return error if the geometry is invalid
+ */
+ErrorEnum SVE::DynamicSimulation::setDesign(const s_engineParamsT<double> &params, const Settings &settings)
+{
+    ErrorEnum ret = _engine.setEngineParams(params);
+    if (ret != ErrorEnum::none)
+        return ret;
+    _tableSettings = settings;
+    _area = SVE::pi<double>() * params.bore * params.bore / 4;
+
+    // torque = net piston force * dx/dtheta (per radian). the top pressure pushes the piston away from TDC
+    double step = 2 * SVE::pi<double>() / tableSteps;
+    _indicatedWork = 0;
+    for (int i=0; i<=tableSteps; i++){
+        double deg = SVE::rad2Deg(i * step);
+        double force = (cylinderPressure(deg, false) - cylinderPressure(deg, true)) * _area;
+        _torque[i] = force * SVE::rad2Deg(SVE::crank2StrokeSlope(deg, params.stroke, params.conRod));
+    }
+    for (int i=0; i<tableSteps; i++)
+        _indicatedWork += (_torque[i] + _torque[i + 1]) / 2 * step;
+    return ErrorEnum::none;
+}
+
+/*!
+ * ideal indicator cycle pressure of one side of the piston at a crank angle
+ * \param deg       crank angle in degrees
+ * \param ret       false for the top side, true for the bottom side
+ */
+double SVE::DynamicSimulation::cylinderPressure(double deg, bool ret) const
+{
+    auto volume = [&](double crank) {
+        return _engine.cylinderVolume(crank, ret);
+    };
+
+    const std::array<double, 8> points = _engine.criticalPoints();
+    int first = ret ? 4 : 0;                            // inlet, cutoff, release, compression of this side
+    CycleEnum region = ret ? _engine.crank2BotCycle(deg) : _engine.crank2TopCycle(deg);
+    switch (region){
+    case CycleEnum::intake:
+        return _tableSettings.supplyPressure;
+    case CycleEnum::expansion:
+        return _tableSettings.supplyPressure * std::pow(volume(points[first + 1]) / volume(deg), _tableSettings.polytropicExponent);
+    case CycleEnum::exahust:
+        return _tableSettings.exahustPressure;
+    case CycleEnum::compression:
+        return _tableSettings.exahustPressure * std::pow(volume(points[first + 3]) / volume(deg), _tableSettings.polytropicExponent);
+    }
+    return _tableSettings.exahustPressure;
+}
+
+double SVE::DynamicSimulation::steamTorque(double deg) const
+{
+    return torqueAt(SVE::deg2Rad(SVE::addAngles(deg, 0)));
+}
+
+const std::vector<SVE::DynamicSimulation::TracePoint> &SVE::DynamicSimulation::trace() const
+{
+    return _trace;
+}
+
+// linear interpolation of the torque table, rad within about one revolution of 0..2pi
+inline double SVE::DynamicSimulation::torqueAt(double rad) const
+{
+    const double scale = tableSteps / (2 * SVE::pi<double>());
+    double f = rad * scale;
+    int i = static_cast<int>(f);
+    if (f < 0)
+        i -= 1;
+    double t = f - i;
+    if (i >= tableSteps)
+        i -= tableSteps;
+    else if (i < 0)
+        i += tableSteps;
+    return _torque[i] + t * (_torque[i + 1] - _torque[i]);
+}
+
+/*!
+ * integrates the crankshaft speed with 4th order Runge-Kutta steps
+ * \param settings  load, flywheel, stepping and run length (the pressure fields are the ones given to setDesign())
+ * \return speed statistics over the last revolutions
+ */
+SVE::DynamicSimulation::Result SVE::DynamicSimulation::run(const Settings &settings)
+{
+    const double twoPi = 2 * SVE::pi<double>();
+    const double inverseInertia = 1 / settings.inertia;
+    const double angleStep = SVE::deg2Rad(settings.angleStep);
+    auto acceleration = [&](double rad, double w) {
+        return (torqueAt(rad) - settings.loadTorque - settings.viscousLoad * w - settings.fanLoad * w * std::fabs(w)) * inverseInertia;
+    };
+
+    Result result{};
+    result.startTime = -1;
+    _revolutions.clear();
+    _revolutions.reserve(settings.revolutions + 1);
+    _trace.clear();
+    // fixed steps end at maxTime, angle steps (each turning the crank by about angleStep) after the revolutions. The trace
+    // is capped at the reserved size, so recording never reallocates inside the loop
+    size_t traceSize = 0;
+    if (settings.traceInterval > 0){
+        double maxSteps = settings.maxTime / settings.timeStep;
+        if (angleStep > 0)
+            maxSteps += settings.revolutions * twoPi / angleStep;
+        traceSize = static_cast<size_t>(std::min(maxSteps, 1e7)) / settings.traceInterval + 1;
+        _trace.reserve(traceSize);
+    }
+
+    double theta = SVE::deg2Rad(SVE::addAngles(settings.initialCrank, 0));
+    double w = settings.initialSpeed;
+    double t = 0;
+    int turns = 0;
+    Revolution current{0, 0, w, w};
+    double revolutionStart = 0;
+
+    // a stationary engine only starts if the steam torque beats the static load
+    if (w <= 0 && torqueAt(theta) <= settings.loadTorque){
+        result.stalled = true;
+        return result;
+    }
+
+    int steps = 0;
+    while (turns < settings.revolutions && t < settings.maxTime){
+        double dt = settings.timeStep;
+        if (angleStep > 0 && w > 0)
+            dt = std::min(dt, angleStep / w);
+
+        double k1w = acceleration(theta, w);
+        double k1t = w;
+        double k2w = acceleration(theta + dt/2 * k1t, w + dt/2 * k1w);
+        double k2t = w + dt/2 * k1w;
+        double k3w = acceleration(theta + dt/2 * k2t, w + dt/2 * k2w);
+        double k3t = w + dt/2 * k2w;
+        double k4w = acceleration(theta + dt * k3t, w + dt * k3w);
+        double k4t = w + dt * k3w;
+        theta += dt/6 * (k1t + 2*k2t + 2*k3t + k4t);
+        w += dt/6 * (k1w + 2*k2w + 2*k3w + k4w);
+        t += dt;
+        steps++;
+
+        if (w <= 0){
+            result.stalled = true;
+            break;
+        }
+        current.mean += w * dt;
+        current.min = std::min(current.min, w);
+        current.max = std::max(current.max, w);
+        if (theta >= twoPi){
+            theta -= twoPi;
+            current.endTime = t;
+            current.mean /= (t - revolutionStart);
+            _revolutions.push_back(current);
+            current = Revolution{0, 0, w, w};
+            revolutionStart = t;
+            turns++;
+        }
+        if (settings.traceInterval > 0 && steps % settings.traceInterval == 0 && _trace.size() < traceSize)
+            _trace.push_back(TracePoint{t, SVE::rad2Deg(theta), w});
+    }
+
+    result.steps = steps;
+    result.time = t;
+    result.revolutions = turns + theta / twoPi;
+    result.indicatedWork = _indicatedWork;
+
+    // statistics over the last revolutions
+    int measured = std::min(settings.measureRevolutions, static_cast<int>(_revolutions.size()));
+    if (measured > 0){
+        double sum = 0;
+        double time = 0;
+        result.minSpeed = std::numeric_limits<double>::infinity();
+        result.maxSpeed = 0;
+        for (size_t i=_revolutions.size() - measured; i<_revolutions.size(); i++){
+            double duration = _revolutions[i].endTime - ((i > 0) ? _revolutions[i - 1].endTime : 0);
+            sum += _revolutions[i].mean * duration;
+            time += duration;
+            result.minSpeed = std::min(result.minSpeed, _revolutions[i].min);
+            result.maxSpeed = std::max(result.maxSpeed, _revolutions[i].max);
+        }
+        result.meanSpeed = sum / time;
+        result.fluctuation = (result.maxSpeed - result.minSpeed) / result.meanSpeed;
+        for (const Revolution &revolution : _revolutions){
+            if (revolution.mean >= 0.9 * result.meanSpeed){
+                result.startTime = revolution.endTime;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+/*!
+ * simulates many designs with the same settings (for example a sweep), one simulation object reused for all of them
+ * \return one result per design, stalled with no steps for invalid designs
+ */
+std::vector<SVE::DynamicSimulation::Result> SVE::simulateDesigns(const std::vector<s_engineParamsT<double>> &designs, const DynamicSimulation::Settings &settings)
+{
+    std::vector<DynamicSimulation::Result> results(designs.size());
+    DynamicSimulation simulation;
+    for (size_t d=0; d<designs.size(); d++){
+        if (simulation.setDesign(designs[d], settings) != ErrorEnum::none){
+            results[d] = DynamicSimulation::Result{};
+            results[d].stalled = true;
+            results[d].startTime = -1;
+            continue;
+        }
+        results[d] = simulation.run(settings);
+    }
+    return results;
+}
@@ -0,0 +1,100 @@
+#ifndef DYNAMICSIMULATION_H
+#define DYNAMICSIMULATION_H
+
+#include <vector>
+#include "slidevalveengine.h"
+
+namespace SVE {
+    /*!
+     * Time domain simulation of the crankshaft speed: the steam torque from the indicator cycle of both sides of the piston
+     * drives a flywheel against a load.
+     *     J dw/dt = steamTorque(crank) - (loadTorque + viscousLoad * w + fanLoad * w^2)
+     * The cylinder pressures only depend on the crank angle (ideal indicator cycle: supply pressure until cutoff, polytropic
+     * expansion to release, back pressure until compression, polytropic compression to inlet), so the steam torque is tabulated
+     * once per design and the stepper only interpolates the table. Any consistent units can be used (e.g. psi, inches,
+     * lbf in s^2 for the inertia); speeds are in rad/s and times in seconds.
+     * Usage:
+     *     SVE::DynamicSimulation::Settings settings = SVE::DynamicSimulation::defaultSettings();
+     *     SVE::DynamicSimulation sim;
+     *     sim.setDesign(engine.getEngineParams(), settings);
+     *     SVE::DynamicSimulation::Result result = sim.run(settings);
+     */
+    class DynamicSimulation
+    {
+    public:
+        struct Settings
+        {
+            double supplyPressure;          // steam chest pressure (absolute)
+            double exahustPressure;         // back pressure (absolute)
+            double polytropicExponent;      // p V^n = const during expansion and compression, about 1.13 for saturated steam
+            double inertia;                 // flywheel and crankshaft
+            double loadTorque;              // constant load, also the static load the engine has to overcome to start
+            double viscousLoad;             // load torque per rad/s
+            double fanLoad;                 // load torque per (rad/s)^2
+            double initialSpeed;            // rad/s, 0 to simulate starting
+            double initialCrank;            // degrees
+            double timeStep;                // fixed time step in s, used if angleStep is 0
+            double angleStep;               // if > 0, the step is this many degrees of crank rotation at the current speed (limited to timeStep)
+            int revolutions;                // simulated revolutions
+            double maxTime;                 // stops early after this many seconds
+            int measureRevolutions;         // the speed statistics are taken over this many last revolutions
+            int traceInterval;              // record every n-th step in trace() (at most 1e7 steps worth), 0 for no trace
+        };
+
+        struct Result
+        {
+            bool stalled;                   // the engine stopped (or could not start)
+            int steps;
+            double time;                    // simulated time
+            double revolutions;
+            double meanSpeed;               // rad/s, over the measured revolutions
+            double minSpeed;
+            double maxSpeed;
+            double fluctuation;             // (max - min) / mean speed, over the measured revolutions
+            double startTime;               // time the revolution average first reached 90% of meanSpeed, -1 if it did not
+            double indicatedWork;           // steam work per revolution, both sides
+        };
+
+        struct TracePoint
+        {
+            double time;
+            double crank;                   // degrees
+            double speed;                   // rad/s
+        };
+
+        static constexpr int tableSteps = 1440;
+
+        DynamicSimulation();
+
+        ErrorEnum setDesign(const s_engineParamsT<double> &params, const Settings &settings);      // builds the torque table
+        Result run(const Settings &settings);
+        double steamTorque(double deg) const;                       // tabulated steam torque at a crank angle
+        double cylinderPressure(double deg, bool ret) const;        // pressure of one side, ret = bottom side
+        const std::vector<TracePoint> &trace() const;               // recorded points of the last run
+
+        static Settings defaultSettings();
+
+    private:
+        struct Revolution
+        {
+            double endTime;
+            double mean;
+            double min;
+            double max;
+        };
+
+        SlideValveEngineT<double> _engine;
+        Settings _tableSettings;                                    // pressure settings the table was built with
+        double _area;                                               // piston area
+        double _torque[tableSteps + 1];                             // steam torque at each table angle (radian steps)
+        double _indicatedWork;
+        std::vector<Revolution> _revolutions;                       // kept between runs so repeated runs do not allocate
+        std::vector<TracePoint> _trace;
+
+        double torqueAt(double rad) const;
+    };
+
+    std::vector<DynamicSimulation::Result> simulateDesigns(const std::vector<s_engineParamsT<double>> &designs, const DynamicSimulation::Settings &settings);
+}
+
+#endif // DYNAMICSIMULATION_H
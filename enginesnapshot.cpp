@@ -0,0 +1,43 @@
+#include "enginesnapshot.h"
+#include <atomic>
+
+/*!
+ * starts with the default engine published
+ */
+template <typename T>
+SVE::EnginePublisher<T>::EnginePublisher()
+{
+    std::atomic_store(&_current, EngineSnapshot<T>(std::make_shared<const SlideValveEngineT<T>>()));
+}
+
+/*!
+ * builds an engine with <params> and publishes it. The current snapshot is unchanged if the parameters are rejected
+ * \param params    new engine parameters
+ * \return error if the engine rejects the parameters
+ */
+template <typename T>
+ErrorEnum SVE::EnginePublisher<T>::publish(const s_engineParamsT<T> &params)
+{
+    std::shared_ptr<SlideValveEngineT<T>> engine = std::make_shared<SlideValveEngineT<T>>();
+    ErrorEnum ret = engine->setEngineParams(params);
+    if (ret == ErrorEnum::none)
+        publish(EngineSnapshot<T>(engine));
+    return ret;
+}
+
+template <typename T>
+void SVE::EnginePublisher<T>::publish(EngineSnapshot<T> engine)
+{
+    if (engine)
+        std::atomic_store(&_current, engine);
+}
+
+template <typename T>
+SVE::EngineSnapshot<T> SVE::EnginePublisher<T>::snapshot() const
+{
+    return std::atomic_load(&_current);
+}
+
+template class SVE::EnginePublisher<float>;
+template class SVE::EnginePublisher<double>;
+template class SVE::EnginePublisher<long double>;
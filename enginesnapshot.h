@@ -0,0 +1,42 @@
+#ifndef ENGINESNAPSHOT_H
+#define ENGINESNAPSHOT_H
+
+#include <memory>
+#include "slidevalveengine.h"
+
+namespace SVE {
+    // an engine that can no longer change: parameters, critical points and the shared kinematic tables.
+    // any number of threads can query it at the same time
+    template <typename T>
+    using EngineSnapshot = std::shared_ptr<const SlideValveEngineT<T>>;
+
+    /*!
+     * Publishes engine snapshots from one writer to any number of reader threads.
+     * The writer builds and validates the next engine privately, then swaps it in atomically. Readers take the current
+     * snapshot with snapshot() and keep using it as long as they like, even after a newer one is published.
+     * Usage:
+     *     SVE::EnginePublisher<double> publisher;
+     *     publisher.publish(newParams);                       // writer
+     *     SVE::EngineSnapshot<double> engine = publisher.snapshot();     // reader, any thread
+     *     double pos = engine->crank2Stroke(deg);
+     */
+    template <typename T>
+    class EnginePublisher
+    {
+    public:
+        EnginePublisher();
+
+        ErrorEnum publish(const s_engineParamsT<T> &params);       // builds an engine for <params> and publishes it if the parameters are valid
+        void publish(EngineSnapshot<T> engine);                     // publishes an engine built elsewhere
+        EngineSnapshot<T> snapshot() const;                         // current engine, never null
+
+    private:
+        EngineSnapshot<T> _current;                                 // only accessed through the std::atomic_ shared_ptr functions
+    };
+
+    extern template class EnginePublisher<float>;
+    extern template class EnginePublisher<double>;
+    extern template class EnginePublisher<long double>;
+}
+
+#endif // ENGINESNAPSHOT_H
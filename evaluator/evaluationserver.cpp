@@ -0,0 +1,214 @@
+#include "evaluationserver.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include "designfile.h"
+
+namespace {
+    // metric names in the responses
+    const QVector<QPair<QString, MetricEnum>> &metrics()
+    {
+        static const QVector<QPair<QString, MetricEnum>> names = {
+            {"cutoff", MetricEnum::cutoff},
+            {"lead", MetricEnum::lead},
+            {"exahustLead", MetricEnum::exahustLead},
+            {"compression", MetricEnum::compression},
+            {"exahustRestriction", MetricEnum::exahustRestriction},
+            {"cushion", MetricEnum::cushion}
+        };
+        return names;
+    }
+
+    QByteArray errorResponse(const QJsonValue &id, const QString &error)
+    {
+        QJsonObject response;
+        response["id"] = id;
+        response["ok"] = false;
+        response["error"] = error;
+        return QJsonDocument(response).toJson(QJsonDocument::Compact) + '\n';
+    }
+}
+
+EvaluationServer::EvaluationServer(const Settings &settings, QObject *parent) : QObject(parent)
+{
+    _settings = settings;
+
+    // keep the workers (and their engines) alive between batches
+    QThreadPool *pool = QThreadPool::globalInstance();
+    if (_settings.threads > 0)
+        pool->setMaxThreadCount(_settings.threads);
+    pool->setExpiryTimeout(-1);
+
+    _batchTimer.setSingleShot(true);
+    _batchTimer.setInterval(_settings.batchWindow);
+    connect(&_batchTimer, SIGNAL(timeout()), this, SLOT(flush()));
+    connect(&_watcher, SIGNAL(finished()), this, SLOT(batchFinished()));
+    connect(&_server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+}
+
+EvaluationServer::~EvaluationServer()
+{
+    _watcher.waitForFinished();
+}
+
+/*!
+ * starts listening. A stale socket file left by a crashed server is removed first
+ * \param error     set to the reason if listening fails
+ * \return true if the server is listening
+ */
+bool EvaluationServer::listen(QString *error)
+{
+    QLocalServer::removeServer(_settings.name);
+    if (_server.listen(_settings.name))
+        return true;
+    if (error)
+        *error = _server.errorString();
+    return false;
+}
+
+void EvaluationServer::newConnection()
+{
+    while (QLocalSocket *client = _server.nextPendingConnection()){
+        connect(client, SIGNAL(readyRead()), this, SLOT(readRequests()));
+        connect(client, SIGNAL(disconnected()), this, SLOT(clientDisconnected()));
+    }
+}
+
+/*!
+ * queues the complete request lines of a client, and starts the batch window. When the queue is full the request is
+ * answered with an error instead, so a client that sends faster than the pool evaluates cannot grow the queue without bound
+ */
+void EvaluationServer::readRequests()
+{
+    QLocalSocket *client = qobject_cast<QLocalSocket *>(sender());
+    if (!client)
+        return;
+
+    while (client->canReadLine()){
+        QByteArray line = client->readLine().trimmed();
+        if (line.isEmpty())
+            continue;
+        Request request = parseRequest(client, line);
+        if (_pending.size() >= _settings.maxPending){
+            client->write(errorResponse(request.id, "server busy"));
+            continue;
+        }
+        _pending.append(request);
+    }
+
+    if (_pending.size() >= _settings.maxBatch)
+        flush();
+    else if (!_pending.isEmpty() && !_batchTimer.isActive())
+        _batchTimer.start();
+}
+
+void EvaluationServer::clientDisconnected()
+{
+    // queued requests of the client are still evaluated, their responses are dropped (the QPointer is cleared)
+    if (QLocalSocket *client = qobject_cast<QLocalSocket *>(sender()))
+        client->deleteLater();
+}
+
+/*!
+ * starts evaluating the pending requests, unless a batch is already running (batchFinished() then starts the next one)
+ */
+void EvaluationServer::flush()
+{
+    _batchTimer.stop();
+    if (_watcher.isRunning() || _pending.isEmpty())
+        return;
+
+    int count = qMin(_pending.size(), _settings.maxBatch);
+    _running = _pending.mid(0, count);
+    _pending.remove(0, count);
+    _watcher.setFuture(QtConcurrent::mapped(_running, &EvaluationServer::evaluate));
+}
+
+/*!
+ * sends the responses of the finished batch, then starts the next one
+ */
+void EvaluationServer::batchFinished()
+{
+    QFuture<QByteArray> results = _watcher.future();
+    for (int i=0; i<_running.size(); i++){
+        QLocalSocket *client = _running[i].client;
+        if (client && client->state() == QLocalSocket::ConnectedState)
+            client->write(results.resultAt(i));
+    }
+    _running.clear();
+
+    if (_pending.size() >= _settings.maxBatch)
+        flush();
+    else if (!_pending.isEmpty() && !_batchTimer.isActive())
+        _batchTimer.start();
+}
+
+/*!
+ * parses one request line, in the socket thread
+ */
+EvaluationServer::Request EvaluationServer::parseRequest(QLocalSocket *client, const QByteArray &line) const
+{
+    Request request;
+    request.client = client;
+    request.dims = SVE::designDims(SVE::defaultEngineParams<double>());
+
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+    if (!document.isObject()){
+        request.error = (parseError.error != QJsonParseError::NoError) ? parseError.errorString() : QString("request is not an object");
+        return request;
+    }
+
+    QJsonObject object = document.object();
+    request.id = object.value("id");
+    QJsonValue designValue = object.value("design");
+    if (!designValue.isObject()){
+        request.error = designValue.isUndefined() ? QString("design is missing") : QString("design is not an object");
+        return request;
+    }
+    QJsonObject design = designValue.toObject();
+    for (const DesignFile::Dimension &dimension : DesignFile::dimensions()){
+        QJsonValue value = design.value(dimension.name);
+        if (value.isUndefined())
+            continue;
+        if (!value.isDouble()){
+            request.error = QString("%1 is not a number").arg(dimension.name);
+            return request;
+        }
+        request.dims.*(dimension.member) = value.toDouble();
+    }
+    return request;
+}
+
+/*!
+ * evaluates one request, in a pool thread
+ * \return the response line
+ */
+QByteArray EvaluationServer::evaluate(const Request &request)
+{
+    if (!request.error.isEmpty())
+        return errorResponse(request.id, request.error);
+
+    // one engine per pool thread, reused between batches
+    thread_local SlideValveEngine engine;
+    if (engine.setEngineParams(SVE::designParams(request.dims)) != ErrorEnum::none)
+        return errorResponse(request.id, "invalid geometry");
+
+    QJsonArray points;
+    for (double point : engine.criticalPoints())
+        points.append(point);
+
+    QJsonObject values;
+    for (const QPair<QString, MetricEnum> &metric : metrics())
+        values[metric.first] = QJsonArray{engine.metric(metric.second, false), engine.metric(metric.second, true)};
+
+    QJsonObject response;
+    response["id"] = request.id;
+    response["ok"] = true;
+    response["criticalPoints"] = points;
+    response["metrics"] = values;
+    return QJsonDocument(response).toJson(QJsonDocument::Compact) + '\n';
+}
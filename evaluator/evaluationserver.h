@@ -0,0 +1,74 @@
+#ifndef EVALUATIONSERVER_H
+#define EVALUATIONSERVER_H
+
+#include <QFutureWatcher>
+#include <QJsonValue>
+#include <QLocalServer>
+#include <QPointer>
+#include <QTimer>
+#include "slidevalveengine.h"
+
+class QLocalSocket;
+
+/*!
+ * Long running design evaluator listening on a local socket (a Unix domain socket on Linux).
+ * Clients send one JSON request per line and get one JSON response per line, in the order the requests were sent:
+ *     {"id": 7, "design": {"valveTravel": 0.5, "eccentricAdvance": 32}}
+ *     {"id": 7, "ok": true, "criticalPoints": [...8 crank angles...], "metrics": {"cutoff": [top, bottom], ...}}
+ * Dimensions missing from "design" are taken from the default engine, names are the design file columns. A request without a
+ * "design" object gets an error response.
+ * Requests from all clients are collected for up to the batch window (or until a batch is full) and evaluated together on the
+ * global thread pool. One batch runs at a time; requests arriving meanwhile form the next batch, so batches grow with the load.
+ * At most maxPending requests wait for a batch; beyond that a request is answered at once with {"ok": false, "error":
+ * "server busy"}, which can arrive ahead of the responses to the client's earlier requests (match it by id).
+ * Pool threads are kept alive and each has its own engine. The engines evaluate directly, without kinematic tables
+ * (a table costs thousands of evaluations, a request only needs the critical point solve and a few positions).
+ */
+class EvaluationServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Settings
+    {
+        QString name;                   // socket name, or full path of the socket file
+        int threads;                    // pool threads, 0 for one per core
+        int batchWindow;                // ms to wait for more requests before evaluating
+        int maxBatch;                   // requests evaluated together at most
+        int maxPending;                 // requests waiting for a batch at most, later ones are refused
+    };
+
+    explicit EvaluationServer(const Settings &settings, QObject *parent = nullptr);
+    ~EvaluationServer();
+
+    bool listen(QString *error = nullptr);
+
+private slots:
+    void newConnection();
+    void readRequests();
+    void clientDisconnected();
+    void flush();
+    void batchFinished();
+
+private:
+    // one request line, parsed in the socket thread so the workers only evaluate
+    struct Request
+    {
+        QPointer<QLocalSocket> client;
+        QJsonValue id;
+        s_designDims dims;
+        QString error;                  // set if the request could not be parsed
+    };
+
+    Settings _settings;
+    QLocalServer _server;
+    QTimer _batchTimer;
+    QVector<Request> _pending;           // waiting for the next batch
+    QVector<Request> _running;           // batch being evaluated
+    QFutureWatcher<QByteArray> _watcher;
+
+    Request parseRequest(QLocalSocket *client, const QByteArray &line) const;
+    static QByteArray evaluate(const Request &request);
+};
+
+#endif // EVALUATIONSERVER_H
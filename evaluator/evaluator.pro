@@ -0,0 +1,28 @@
+QT       += core network concurrent
+QT       -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = slideValveEvaluator
+
+# the engine sources are shared with the designer
+INCLUDEPATH += ..
+
+SOURCES += \
+    ../designfile.cpp \
+    ../kinematictable.cpp \
+    ../slidevalveengine.cpp \
+    evaluationserver.cpp \
+    main.cpp
+
+HEADERS += \
+    ../designfile.h \
+    ../kinematictable.h \
+    ../slidevalveengine.h \
+    evaluationserver.h
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,37 @@
+#include "evaluationserver.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("slideValveEvaluator");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Evaluates slide valve designs for client scripts over a local socket (JSON lines)");
+    parser.addHelpOption();
+    QCommandLineOption socketOption("socket", "Socket name, or full path of the socket file.", "name", "slideValveEvaluator");
+    QCommandLineOption threadsOption("threads", "Evaluation threads (0 = one per core).", "count", "0");
+    QCommandLineOption windowOption("batch-window", "Milliseconds to collect requests before evaluating a batch.", "ms", "2");
+    QCommandLineOption batchOption("max-batch", "Largest batch evaluated at once.", "requests", "4096");
+    QCommandLineOption pendingOption("max-pending", "Most requests waiting for a batch, later ones get a \"server busy\" error.", "requests", "65536");
+    parser.addOptions({socketOption, threadsOption, windowOption, batchOption, pendingOption});
+    parser.process(a);
+
+    EvaluationServer::Settings settings;
+    settings.name = parser.value(socketOption);
+    settings.threads = parser.value(threadsOption).toInt();
+    settings.batchWindow = qMax(0, parser.value(windowOption).toInt());
+    settings.maxBatch = qMax(1, parser.value(batchOption).toInt());
+    settings.maxPending = qMax(1, parser.value(pendingOption).toInt());
+
+    EvaluationServer server(settings);
+    QString error;
+    if (!server.listen(&error)){
+        QTextStream(stderr) << "could not listen on " << settings.name << ": " << error << '\n';
+        return 1;
+    }
+    return a.exec();
+}
@@ -0,0 +1,88 @@
+#ifndef FIXEDGEOMETRYENGINE_H
+#define FIXEDGEOMETRYENGINE_H
+
+#include "kinematictable.h"
+
+namespace SVE {
+    // the default geometry as an object with static storage, so it can be used as a FixedGeometryEngine parameter
+    template <typename T>
+    struct DefaultGeometry
+    {
+        static constexpr s_engineParamsT<T> params = defaultEngineParams<T>();
+    };
+}
+
+/*!
+ * Engine with the geometry fixed at compile time. The critical points and the piston / valve position tables
+ * are computed by the compiler, so there is no setup cost at runtime. Positions are interpolated from tables with N steps per revolution.
+ * Usage:
+ *     constexpr s_engineParams myGeometry = {...};
+ *     typedef FixedGeometryEngine<double, myGeometry> MyEngine;
+ *     double cutoff = MyEngine::criticalPoints()[1];
+ */
+template <typename T, const s_engineParamsT<T> &Geometry, int N = 720>
+class FixedGeometryEngine
+{
+    static_assert(SVE::checkGeometry(Geometry) == ErrorEnum::none, "fixed engine geometry is invalid");
+
+public:
+    static constexpr s_engineParamsT<T> getEngineParams()
+    {
+        return Geometry;
+    }
+
+    static constexpr std::array<T, 4> topCriticalPoints()
+    {
+        return {{_criticalPoints[0], _criticalPoints[1], _criticalPoints[2], _criticalPoints[3]}};
+    }
+
+    static constexpr std::array<T, 4> botCriticalPoints()
+    {
+        return {{_criticalPoints[4], _criticalPoints[5], _criticalPoints[6], _criticalPoints[7]}};
+    }
+
+    static constexpr std::array<T, 8> criticalPoints()
+    {
+        return _criticalPoints;
+    }
+
+    static constexpr T crank2Stroke(T deg)
+    {
+        return _strokeTable.at(deg);
+    }
+
+    static constexpr T crank2ValvePos(T deg)
+    {
+        return _valveTable.at(deg);
+    }
+
+    static constexpr CycleEnum crank2TopCycle(T deg)
+    {
+        return SVE::cycleRegion(deg, topCriticalPoints());
+    }
+
+    static constexpr CycleEnum crank2BotCycle(T deg)
+    {
+        return SVE::cycleRegion(deg, botCriticalPoints());
+    }
+
+    static constexpr int nextTopCriticalPoint(T deg)
+    {
+        return SVE::nextPoint(deg, topCriticalPoints());
+    }
+
+    static constexpr int nextBotCriticalPoint(T deg)
+    {
+        return SVE::nextPoint(deg, botCriticalPoints());
+    }
+
+private:
+    static constexpr std::array<T, 8> _criticalPoints = SVE::criticalPoints(Geometry, SVE::cx::stroke2Crank<T>);
+    static constexpr SVE::KinematicTable<T, N> _strokeTable = SVE::makeKinematicTable<T, N>(Geometry.stroke, Geometry.conRod, T(0), T(0));
+    static constexpr SVE::KinematicTable<T, N> _valveTable = SVE::makeKinematicTable<T, N>(Geometry.valveTravel, Geometry.valveConRod,
+                                                                                          Geometry.eccentricAdvance, Geometry.valveTravel / 2);
+};
+
+typedef FixedGeometryEngine<double, SVE::DefaultGeometry<double>::params> DefaultFixedEngine;
+
+#endif // FIXEDGEOMETRYENGINE_H
@@ -0,0 +1,270 @@
+#include "heatmapview.h"
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QFileDialog>
+#include <QGridLayout>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+
+HeatmapView::HeatmapView(QWidget *parent) :
+    QWidget(parent)
+{
+    _base = SVE::designDims(SVE::defaultEngineParams<double>());
+    _sweep = new DesignSweep(this);
+
+    // controls
+    QStringList dimensionNames;
+    for (const DesignFile::Dimension &dimension : DesignFile::dimensions())
+        dimensionNames << dimension.name;
+    auto makeRangeBox = [this]{
+        QDoubleSpinBox *box = new QDoubleSpinBox(this);
+        box->setDecimals(3);
+        box->setRange(-1000, 1000);
+        box->setSingleStep(0.1);
+        return box;
+    };
+    _xDimension = new QComboBox(this);
+    _xDimension->addItems(dimensionNames);
+    _xDimension->setCurrentIndex(5);            // eccentric advance
+    _yDimension = new QComboBox(this);
+    _yDimension->addItems(dimensionNames);
+    _yDimension->setCurrentIndex(3);            // valve travel
+    _xMin = makeRangeBox();
+    _xMax = makeRangeBox();
+    _yMin = makeRangeBox();
+    _yMax = makeRangeBox();
+    _metric = new QComboBox(this);
+    _metric->addItem("Cutoff (% stroke)", static_cast<int>(MetricEnum::cutoff));
+    _metric->addItem("Lead", static_cast<int>(MetricEnum::lead));
+    _metric->addItem("Exahust Lead", static_cast<int>(MetricEnum::exahustLead));
+    _metric->addItem("Compression (% stroke)", static_cast<int>(MetricEnum::compression));
+    _metric->addItem("Exahust Restriction (< 1 restricted)", static_cast<int>(MetricEnum::exahustRestriction));
+    _metric->addItem("Cushion (compression ratio)", static_cast<int>(MetricEnum::cushion));
+    _side = new QComboBox(this);
+    _side->addItems(QStringList{"Forward (top)", "Return (bottom)"});
+    _resolution = new QComboBox(this);
+    for (int levels=6; levels<=9; levels++)
+        _resolution->addItem(QString("%1 x %1").arg(1 << levels), levels);
+    _resolution->setCurrentIndex(2);
+    _start = new QPushButton("Sweep", this);
+    _stop = new QPushButton("Stop", this);
+    _stop->setEnabled(false);
+    _save = new QPushButton("Save CSV...", this);
+    _save->setEnabled(false);
+    _status = new QLabel(this);
+    _probe = new QLabel(this);
+
+    // plot
+    _plot = new QCustomPlot(this);
+    _plot->setInteraction(QCP::iRangeDrag, true);
+    _plot->setInteraction(QCP::iRangeZoom, true);
+    _colorMap = new QCPColorMap(_plot->xAxis, _plot->yAxis);
+    _colorScale = new QCPColorScale(_plot);
+    _plot->plotLayout()->addElement(0, 1, _colorScale);
+    _colorMap->setColorScale(_colorScale);
+    _colorMap->setGradient(QCPColorGradient::gpJet);
+    _colorMap->setInterpolate(false);
+    QCPMarginGroup *marginGroup = new QCPMarginGroup(_plot);
+    _plot->axisRect()->setMarginGroup(QCP::msBottom | QCP::msTop, marginGroup);
+    _colorScale->setMarginGroup(QCP::msBottom | QCP::msTop, marginGroup);
+
+    QGridLayout *layout = new QGridLayout(this);
+    layout->addWidget(new QLabel("X", this), 0, 0);
+    layout->addWidget(_xDimension, 0, 1);
+    layout->addWidget(_xMin, 0, 2);
+    layout->addWidget(_xMax, 0, 3);
+    layout->addWidget(new QLabel("Metric", this), 0, 4);
+    layout->addWidget(_metric, 0, 5);
+    layout->addWidget(_resolution, 0, 6);
+    layout->addWidget(_start, 0, 7);
+    layout->addWidget(_save, 0, 8);
+    layout->addWidget(new QLabel("Y", this), 1, 0);
+    layout->addWidget(_yDimension, 1, 1);
+    layout->addWidget(_yMin, 1, 2);
+    layout->addWidget(_yMax, 1, 3);
+    layout->addWidget(new QLabel("Side", this), 1, 4);
+    layout->addWidget(_side, 1, 5);
+    layout->addWidget(_status, 1, 6);
+    layout->addWidget(_stop, 1, 7);
+    layout->addWidget(_probe, 1, 8);
+    layout->addWidget(_plot, 2, 0, 1, 9);
+    layout->setRowStretch(2, 1);
+
+    connect(_xDimension, SIGNAL(currentIndexChanged(int)), this, SLOT(dimensionChanged()));
+    connect(_yDimension, SIGNAL(currentIndexChanged(int)), this, SLOT(dimensionChanged()));
+    connect(_start, SIGNAL(clicked()), this, SLOT(startSweep()));
+    connect(_stop, SIGNAL(clicked()), _sweep, SLOT(cancel()));
+    connect(_save, SIGNAL(clicked()), this, SLOT(saveCsv()));
+    // the sweep signals come from a worker thread, so they are queued to this one
+    connect(_sweep, SIGNAL(levelFinished(int, int)), this, SLOT(levelFinished(int, int)), Qt::QueuedConnection);
+    connect(_sweep, SIGNAL(finished()), this, SLOT(sweepFinished()));
+    _plot->setMouseTracking(true);          // mouseMove without a button held
+    connect(_plot, SIGNAL(mouseMove(QMouseEvent*)), this, SLOT(probe(QMouseEvent*)));
+
+    setDefaultRange(_xDimension, _xMin, _xMax);
+    setDefaultRange(_yDimension, _yMin, _yMax);
+}
+
+void HeatmapView::setBaseDesign(const s_designDims &dims)
+{
+    _base = dims;
+}
+
+const DesignSweep *HeatmapView::sweep() const
+{
+    return _sweep;
+}
+
+/*!
+ * sets a range of +-25% around the base design value for the selected dimension
+ */
+void HeatmapView::setDefaultRange(QComboBox *dimension, QDoubleSpinBox *min, QDoubleSpinBox *max)
+{
+    double value = _base.*(DesignFile::dimensions()[dimension->currentIndex()].member);
+    double span = qMax(std::fabs(value) * 0.25, 0.1);
+    min->setValue(value - span);
+    max->setValue(value + span);
+}
+
+void HeatmapView::dimensionChanged()
+{
+    if (sender() == _xDimension)
+        setDefaultRange(_xDimension, _xMin, _xMax);
+    else
+        setDefaultRange(_yDimension, _yMin, _yMax);
+}
+
+void HeatmapView::startSweep()
+{
+    if (_xDimension->currentIndex() == _yDimension->currentIndex() || _xMin->value() >= _xMax->value() || _yMin->value() >= _yMax->value()){
+        _status->setText("choose two dimensions and increasing ranges");
+        return;
+    }
+
+    DesignSweep::Settings settings;
+    settings.base = _base;
+    settings.xDimension = _xDimension->currentIndex();
+    settings.yDimension = _yDimension->currentIndex();
+    settings.xRange = QCPRange(_xMin->value(), _xMax->value());
+    settings.yRange = QCPRange(_yMin->value(), _yMax->value());
+    settings.metric = static_cast<MetricEnum>(_metric->currentData().toInt());
+    settings.ret = _side->currentIndex() == 1;
+    settings.levels = _resolution->currentData().toInt();
+
+    _colorMap->data()->setSize(0, 0);
+    _plot->xAxis->setLabel(_xDimension->currentText());
+    _plot->yAxis->setLabel(_yDimension->currentText());
+    _plot->xAxis->setRange(settings.xRange);
+    _plot->yAxis->setRange(settings.yRange);
+    _colorScale->axis()->setLabel(_metric->currentText());
+    _start->setEnabled(false);
+    _stop->setEnabled(true);
+    _save->setEnabled(false);
+    _status->setText("sweeping...");
+    _surrogate.clear();
+    _probe->clear();
+    _sweep->start(settings);
+}
+
+/*!
+ * shows the grid after a refinement level
+ */
+void HeatmapView::levelFinished(int level, int levels)
+{
+    DesignSweep::Settings settings = _sweep->settings();
+    int size = _sweep->gridSize();
+    QVector<double> values = _sweep->values();
+    if (values.size() != size * size)
+        return;
+
+    QCPColorMapData *data = _colorMap->data();
+    if (data->keySize() != size || data->valueSize() != size){
+        data->setSize(size, size);
+        data->setRange(settings.xRange, settings.yRange);
+    }
+    // invalid designs are transparent (the color map has no NaN handling of its own)
+    for (int i=0; i<size; i++){
+        for (int j=0; j<size; j++){
+            double value = values[i * size + j];
+            bool valid = !qIsNaN(value);
+            data->setCell(i, j, valid ? value : 0);
+            data->setAlpha(i, j, valid ? 255 : 0);
+        }
+    }
+    // range of the valid cells only, the placeholder 0 of invalid cells would stretch it
+    QCPRange range;
+    bool first = true;
+    for (double value : values){
+        if (qIsNaN(value))
+            continue;
+        if (first)
+            range = QCPRange(value, value);
+        else
+            range.expand(value);
+        first = false;
+    }
+    if (!first)
+        _colorMap->setDataRange(range);
+    _status->setText(QString("level %1 of %2").arg(level + 1).arg(levels - qMin(4, levels) + 1));
+    _plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void HeatmapView::sweepFinished()
+{
+    _start->setEnabled(true);
+    _stop->setEnabled(false);
+    int evaluated = _sweep->evaluatedCount();
+    _save->setEnabled(evaluated > 0);
+    int size = _sweep->gridSize();
+    _status->setText(QString("%1 of %2 points calculated").arg(evaluated).arg(size * size));
+
+    // fit the probe surrogate to the calculated points
+    DesignSweep::Settings settings = _sweep->settings();
+    const QVector<DesignFile::Dimension> &dims = DesignFile::dimensions();
+    QVector<double> values;
+    QVector<DesignFile::Design> designs = _sweep->designs(&values);
+    std::vector<s_designDims> samples;
+    samples.reserve(designs.size());
+    for (const DesignFile::Design &design : designs)
+        samples.push_back(design.dims);
+    _surrogate.fit(samples, std::vector<double>(values.begin(), values.end()),
+                   {dims[settings.xDimension].member, dims[settings.yDimension].member}, settings.metric, settings.ret);
+}
+
+/*!
+ * shows the metric at the mouse position, from the surrogate if it is within 0.1% of the map's range, otherwise from the engine
+ */
+void HeatmapView::probe(QMouseEvent *event)
+{
+    if (!_surrogate.isFitted())
+        return;
+
+    DesignSweep::Settings settings = _sweep->settings();
+    const QVector<DesignFile::Dimension> &dims = DesignFile::dimensions();
+    s_designDims design = settings.base;
+    design.*(dims[settings.xDimension].member) = _plot->xAxis->pixelToCoord(event->pos().x());
+    design.*(dims[settings.yDimension].member) = _plot->yAxis->pixelToCoord(event->pos().y());
+    if (!settings.xRange.contains(design.*(dims[settings.xDimension].member)) || !settings.yRange.contains(design.*(dims[settings.yDimension].member))){
+        _probe->clear();
+        return;
+    }
+
+    SVE::MetricSurrogate::Estimate estimate = _surrogate.evaluate(design, 0.001 * _colorMap->dataRange().size());
+    if (qIsNaN(estimate.value))
+        _probe->setText("invalid design");
+    else if (estimate.exact)
+        _probe->setText(QString("%1 (exact)").arg(estimate.value, 0, 'g', 5));
+    else
+        _probe->setText(QString("%1 +- %2").arg(estimate.value, 0, 'g', 5).arg(estimate.error, 0, 'g', 2));
+}
+
+void HeatmapView::saveCsv()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, "Save Sweep", "sweep.csv", "CSV (*.csv)");
+    if (fileName.isEmpty())
+        return;
+    QString error;
+    if (!_sweep->writeCsv(fileName, &error))
+        QMessageBox::warning(this, "Save Sweep", "Could not save " + fileName + ": " + error);
+}
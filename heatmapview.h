@@ -0,0 +1,63 @@
+#ifndef HEATMAPVIEW_H
+#define HEATMAPVIEW_H
+
+#include <QWidget>
+#include "qcustomplot.h"
+#include "designsweep.h"
+#include "surrogate.h"
+
+class QComboBox;
+class QDoubleSpinBox;
+class QLabel;
+class QPushButton;
+
+/*!
+ * Design space tab: a heatmap of a metric over two design dimensions, varied from the current design.
+ * The map is filled by a DesignSweep in the background and redrawn as each refinement level finishes, so it can be
+ * panned and zoomed while the sweep runs. Once the sweep finishes, a surrogate fitted to it gives the metric under the
+ * mouse anywhere in the swept box (the engine is used where the surrogate is not accurate enough).
+ */
+class HeatmapView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit HeatmapView(QWidget *parent = nullptr);
+
+    void setBaseDesign(const s_designDims &dims);       // design the sweep varies, usually the current design
+    const DesignSweep *sweep() const;
+
+private slots:
+    void startSweep();
+    void saveCsv();
+    void dimensionChanged();
+    void levelFinished(int level, int levels);
+    void sweepFinished();
+    void probe(QMouseEvent *event);
+
+private:
+    s_designDims _base;
+    DesignSweep *_sweep;
+    QCustomPlot *_plot;
+    QCPColorMap *_colorMap;
+    QCPColorScale *_colorScale;
+    QComboBox *_xDimension;
+    QComboBox *_yDimension;
+    QDoubleSpinBox *_xMin;
+    QDoubleSpinBox *_xMax;
+    QDoubleSpinBox *_yMin;
+    QDoubleSpinBox *_yMax;
+    QComboBox *_metric;
+    QComboBox *_side;
+    QComboBox *_resolution;
+    QPushButton *_start;
+    QPushButton *_stop;
+    QPushButton *_save;
+    QLabel *_status;
+    QLabel *_probe;                                     // metric under the mouse
+    SVE::MetricSurrogate _surrogate;                    // fitted to the last finished sweep, for the mouse probe
+
+    void setDefaultRange(QComboBox *dimension, QDoubleSpinBox *min, QDoubleSpinBox *max);
+};
+
+#endif // HEATMAPVIEW_H
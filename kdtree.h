@@ -0,0 +1,155 @@
+#ifndef KDTREE_H
+#define KDTREE_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace SVE {
+    /*!
+     * Static k-d tree over K dimensional points, for nearest point and box queries.
+     * The tree is implicit: build() reorders the point indices so each range's median is its node, and splits each range on
+     * the axis with the largest variance (sweep results usually vary only a few of the axes). Queries return indices into the points passed to build().
+     */
+    template <typename T, int K>
+    class KdTree
+    {
+    public:
+        typedef std::array<T, K> Point;
+
+        void build(const std::vector<Point> &points)
+        {
+            _points = points;
+            _order.resize(points.size());
+            _axis.assign(points.size(), 0);
+            for (size_t i=0; i<_order.size(); i++)
+                _order[i] = static_cast<int>(i);
+            buildRange(0, static_cast<int>(_order.size()));
+        }
+
+        int size() const
+        {
+            return static_cast<int>(_points.size());
+        }
+
+        const Point &point(int i) const
+        {
+            return _points[i];
+        }
+
+        /*!
+         * finds the point closest to <query>, with each axis difference multiplied by <scale> (so axes with different units can be balanced)
+         * \param distance  if not null, set to the scaled distance to the point found
+         * \return index of the closest point, -1 if the tree is empty
+         */
+        int nearest(const Point &query, const Point &scale, T *distance = nullptr) const
+        {
+            int best = -1;
+            T bestDist2 = std::numeric_limits<T>::infinity();
+            nearestRange(0, static_cast<int>(_order.size()), query, scale, best, bestDist2);
+            if (distance)
+                *distance = std::sqrt(bestDist2);
+            return best;
+        }
+
+        /*!
+         * finds the points inside the box lower <= point <= upper (use +-infinity for unbounded axes)
+         * \param found     indices of the points in the box are appended here
+         */
+        void range(const Point &lower, const Point &upper, std::vector<int> &found) const
+        {
+            rangeRange(0, static_cast<int>(_order.size()), lower, upper, found);
+        }
+
+    private:
+        std::vector<Point> _points;
+        std::vector<int> _order;            // point indices in tree order, the node of range [lo, hi) is _order[(lo + hi) / 2]
+        std::vector<int> _axis;             // split axis of the node at each tree position
+
+        void buildRange(int lo, int hi)
+        {
+            if (hi - lo < 2)
+                return;
+
+            // split on the axis with the largest variance (a few outliers do not pull the splits away from the swept axes)
+            int axis = 0;
+            T widest = -1;
+            for (int k=0; k<K; k++){
+                T sum = 0;
+                T sum2 = 0;
+                for (int i=lo; i<hi; i++){
+                    T x = _points[_order[i]][k];
+                    sum += x;
+                    sum2 += x*x;
+                }
+                T variance = sum2 - sum*sum / (hi - lo);
+                if (variance > widest){
+                    widest = variance;
+                    axis = k;
+                }
+            }
+
+            int mid = (lo + hi) / 2;
+            std::nth_element(_order.begin() + lo, _order.begin() + mid, _order.begin() + hi,
+                             [this, axis](int a, int b) { return _points[a][axis] < _points[b][axis]; });
+            _axis[mid] = axis;
+            buildRange(lo, mid);
+            buildRange(mid + 1, hi);
+        }
+
+        void nearestRange(int lo, int hi, const Point &query, const Point &scale, int &best, T &bestDist2) const
+        {
+            if (lo >= hi)
+                return;
+            int mid = (lo + hi) / 2;
+            const Point &node = _points[_order[mid]];
+
+            T dist2 = 0;
+            for (int k=0; k<K; k++){
+                T d = (node[k] - query[k]) * scale[k];
+                dist2 += d*d;
+            }
+            if (dist2 < bestDist2){
+                bestDist2 = dist2;
+                best = _order[mid];
+            }
+
+            // search the side holding the query first, the other side only if the splitting plane is closer than the best so far
+            int axis = _axis[mid];
+            T split = (query[axis] - node[axis]) * scale[axis];
+            if (split < 0){
+                nearestRange(lo, mid, query, scale, best, bestDist2);
+                if (split*split < bestDist2)
+                    nearestRange(mid + 1, hi, query, scale, best, bestDist2);
+            }else{
+                nearestRange(mid + 1, hi, query, scale, best, bestDist2);
+                if (split*split < bestDist2)
+                    nearestRange(lo, mid, query, scale, best, bestDist2);
+            }
+        }
+
+        void rangeRange(int lo, int hi, const Point &lower, const Point &upper, std::vector<int> &found) const
+        {
+            if (lo >= hi)
+                return;
+            int mid = (lo + hi) / 2;
+            const Point &node = _points[_order[mid]];
+
+            bool inside = true;
+            for (int k=0; k<K && inside; k++)
+                inside = node[k] >= lower[k] && node[k] <= upper[k];
+            if (inside)
+                found.push_back(_order[mid]);
+
+            int axis = _axis[mid];
+            if (lower[axis] <= node[axis])
+                rangeRange(lo, mid, lower, upper, found);
+            if (upper[axis] >= node[axis])
+                rangeRange(mid + 1, hi, lower, upper, found);
+        }
+    };
+}
+
+#endif // KDTREE_H
@@ -0,0 +1,173 @@
+#include "kinematictable.h"
+#include <limits>
+#include <list>
+#include <map>
+#include <mutex>
+
+template <typename T>
+SVE::CrankTable<T>::CrankTable(T stroke, T length)
+{
+    _stroke = stroke;
+    _length = length;
+
+    for (int i=0; i<=steps; i++){
+        T deg = i * KinematicTable<T, steps>::step();
+        _table.value[i] = SVE::crank2Stroke(deg, stroke, length);
+        _table.slope[i] = SVE::crank2StrokeSlope(deg, stroke, length);
+    }
+
+    // measure the interpolation error between the table points
+    _maxError = 0;
+    for (int i=0; i<steps; i++){
+        for (T t : {T(0.25), T(0.5), T(0.75)}){
+            T deg = (i + t) * KinematicTable<T, steps>::step();
+            T err = std::fabs(_table.segment(i, t) - SVE::crank2Stroke(deg, stroke, length));
+            if (err > _maxError)
+                _maxError = err;
+        }
+    }
+}
+
+/*!
+ * interpolated stroke position for crank position <deg>. Same conventions as SVE::crank2Stroke
+ */
+template <typename T>
+T SVE::CrankTable<T>::crank2Stroke(T deg) const
+{
+    return _table.at(deg);
+}
+
+/*!
+ * inverse of crank2Stroke() from the table. Same conventions as SVE::stroke2Crank
+ * \param pos       Stroke position
+ * \param ret       if true, the crankshaft position is calculated assuming the return stroke (return value will be between 180 and 360)
+ */
+template <typename T>
+T SVE::CrankTable<T>::stroke2Crank(T pos, bool ret) const
+{
+    // trap for the extreams
+    if (pos <= 0)
+        return T(0.0);
+    else if (pos >= _stroke)
+        return T(180.0);
+
+    // the forward stroke half of the table increases from 0 to stroke, find the segment holding pos
+    int lo = 0;
+    int hi = steps / 2;
+    while (hi - lo > 1){
+        int mid = (lo + hi) / 2;
+        if (_table.value[mid] <= pos)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    // solve the segment polynomial for pos with Newton's method, falling back to bisection if it leaves the segment
+    T tLo = 0;
+    T tHi = 1;
+    T t = (pos - _table.value[lo]) / (_table.value[hi] - _table.value[lo]);
+    for (int i=0; i<30; i++){
+        T err = _table.segment(lo, t) - pos;
+        if (err == 0)
+            break;
+        if (err > 0)
+            tHi = t;
+        else
+            tLo = t;
+        T next = t - err / _table.segmentSlope(lo, t);
+        if (!(next > tLo && next < tHi))
+            next = (tLo + tHi) / 2;
+        if (next == t)
+            break;
+        t = next;
+    }
+
+    T a = (lo + t) * KinematicTable<T, steps>::step();
+    //correct for return stroke
+    if (ret)
+        return T(360.0) - a;
+    else
+        return a;
+}
+
+template <typename T>
+T SVE::CrankTable<T>::stroke() const
+{
+    return _stroke;
+}
+
+template <typename T>
+T SVE::CrankTable<T>::length() const
+{
+    return _length;
+}
+
+template <typename T>
+T SVE::CrankTable<T>::maxError() const
+{
+    return _maxError;
+}
+
+template <typename T>
+bool SVE::CrankTable<T>::accurate() const
+{
+    // 10^4 rounding steps, relative to the stroke. (about 2e-12 of the stroke for double)
+    // long double tables are never accurate enough, so long double engines keep using the exact calculation for reference checks
+    return _maxError <= std::numeric_limits<T>::epsilon() * T(1e4) * _stroke;
+}
+
+template <typename T>
+constexpr bool SVE::CrankTable<T>::usable()
+{
+    // the quarter degree interpolation error is about 1e-12 of the stroke, more than accurate() allows for long double
+    return std::numeric_limits<T>::epsilon() >= std::numeric_limits<double>::epsilon();
+}
+
+template <typename T>
+std::shared_ptr<const SVE::CrankTable<T>> SVE::CrankTable<T>::get(T stroke, T length)
+{
+    if (!usable())
+        return nullptr;
+
+    // the least recently used table is dropped when the cache is full (engines still using it keep their copy alive).
+    // inaccurate geometries are cached as null so their table is not built again
+    const size_t maxTables = 256;
+    typedef std::pair<T, T> Key;
+    typedef std::list<std::pair<Key, std::shared_ptr<const CrankTable<T>>>> Recent;    // most recently used first
+    static std::mutex cacheMutex;
+    static Recent recent;
+    static std::map<Key, typename Recent::iterator> cache;
+
+    Key key(stroke, length);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto found = cache.find(key);
+        if (found != cache.end()){
+            recent.splice(recent.begin(), recent, found->second);
+            return found->second->second;
+        }
+    }
+
+    // build outside the lock so other threads are not held up. If two threads build the same table, the first one in is kept
+    std::shared_ptr<const CrankTable<T>> table = std::make_shared<const CrankTable<T>>(stroke, length);
+    if (!table->accurate())
+        table.reset();
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto found = cache.find(key);
+    if (found != cache.end()){
+        recent.splice(recent.begin(), recent, found->second);
+        return found->second->second;
+    }
+    recent.emplace_front(key, table);
+    cache[key] = recent.begin();
+    if (recent.size() > maxTables){
+        cache.erase(recent.back().first);
+        recent.pop_back();
+    }
+    return table;
+}
+
+template class SVE::CrankTable<float>;
+template class SVE::CrankTable<double>;
+template class SVE::CrankTable<long double>;
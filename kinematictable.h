@@ -0,0 +1,208 @@
+#ifndef KINEMATICTABLE_H
+#define KINEMATICTABLE_H
+
+#include <memory>
+#include "slidevalveengine.h"
+
+namespace SVE {
+
+    // math usable in constant expressions. Evaluated in long double and rounded to <T> at the end,
+    // so compile time results agree with the runtime std:: functions to within rounding
+    namespace cx {
+        constexpr long double sqrt(long double x)
+        {
+            if (x <= 0)
+                return 0;
+            long double guess = (x > 1) ? x : 1;            // start above the root, Newton then decreases monotonically
+            for (int i=0; i<200; i++){
+                long double next = (guess + x/guess) / 2;
+                if (next >= guess)
+                    break;
+                guess = next;
+            }
+            return guess;
+        }
+
+        constexpr long double cos(long double rad)
+        {
+            // reduce to -pi..pi then sum the Taylor series
+            long double twoPi = 2 * pi<long double>();
+            long double x = rad - twoPi * static_cast<long long>(rad / twoPi);
+            if (x > pi<long double>())
+                x -= twoPi;
+            else if (x < -pi<long double>())
+                x += twoPi;
+            long double term = 1;
+            long double sum = 1;
+            for (int n=1; n<30; n++){
+                term *= -x*x / ((2*n - 1) * (2*n));
+                sum += term;
+            }
+            return sum;
+        }
+
+        constexpr long double sin(long double rad)
+        {
+            return cos(rad - pi<long double>() / 2);
+        }
+
+        constexpr long double acos(long double x)
+        {
+            // cos is decreasing on 0..pi, so bisect for the angle
+            long double lo = 0;
+            long double hi = pi<long double>();
+            for (int i=0; i<200; i++){
+                long double mid = (lo + hi) / 2;
+                if (mid == lo || mid == hi)
+                    break;
+                if (cos(mid) > x)
+                    lo = mid;
+                else
+                    hi = mid;
+            }
+            return (lo + hi) / 2;
+        }
+
+        /*!
+         * constant expression version of SVE::crank2Stroke
+         */
+        template <typename T>
+        constexpr T crank2Stroke(T deg, T stroke, T length)
+        {
+            long double r = stroke / 2.0L;
+            long double rad = deg2Rad<long double>(deg);
+            long double rSin = r * sin(rad);
+            long double x = r * cos(rad) + sqrt(static_cast<long double>(length)*length - rSin*rSin);
+            return static_cast<T>(length + r - x);
+        }
+
+        /*!
+         * derivative of SVE::crank2Stroke with respect to crank angle, in stroke units per degree
+         */
+        template <typename T>
+        constexpr T crank2StrokeSlope(T deg, T stroke, T length)
+        {
+            long double r = stroke / 2.0L;
+            long double rad = deg2Rad<long double>(deg);
+            long double rSin = r * sin(rad);
+            long double dxdRad = rSin + rSin * r * cos(rad) / sqrt(static_cast<long double>(length)*length - rSin*rSin);
+            return static_cast<T>(deg2Rad<long double>(dxdRad));
+        }
+
+        /*!
+         * constant expression version of SVE::stroke2Crank
+         */
+        template <typename T>
+        constexpr T stroke2Crank(T pos, T stroke, T length, bool ret)
+        {
+            // trap for the extreams
+            if (pos <= 0)
+                return T(0.0);
+            else if (pos >= stroke)
+                return T(180.0);
+
+            long double r = stroke / 2.0L;
+            long double x = (length + r) - pos;
+            long double arg = (x*x + r*r - static_cast<long double>(length)*length) / (2*r*x);
+            T a = static_cast<T>(rad2Deg<long double>(acos(arg)));
+            return ret ? T(360.0) - a : a;
+        }
+    }
+
+    /*!
+     * Uniform table of a kinematic position over one revolution (0 to 360 degrees in N steps) with its slope,
+     * interpolated with cubic Hermite splines. Can be built and queried in constant expressions.
+     */
+    template <typename T, int N>
+    struct KinematicTable
+    {
+        T value[N + 1];         // position at each table angle
+        T slope[N + 1];         // derivative of the position in units per degree at each table angle
+
+        static constexpr T step()
+        {
+            return T(360.0) / N;
+        }
+
+        constexpr T at(T deg) const
+        {
+            T wrapped = addAngles(deg, 0);
+            int i = static_cast<int>(wrapped / step());
+            if (i >= N)
+                i = N - 1;
+            return segment(i, (wrapped - i*step()) / step());
+        }
+
+        // Hermite interpolation within segment i (between table points i and i+1), 0 <= t <= 1
+        constexpr T segment(int i, T t) const
+        {
+            T h = step();
+            T t2 = t*t;
+            T t3 = t2*t;
+            return (2*t3 - 3*t2 + 1) * value[i] + (t3 - 2*t2 + t) * h * slope[i]
+                    + (3*t2 - 2*t3) * value[i + 1] + (t3 - t2) * h * slope[i + 1];
+        }
+
+        // derivative of segment(i, t) with respect to t
+        constexpr T segmentSlope(int i, T t) const
+        {
+            T h = step();
+            T t2 = t*t;
+            return (6*t2 - 6*t) * value[i] + (3*t2 - 4*t + 1) * h * slope[i]
+                    + (6*t - 6*t2) * value[i + 1] + (3*t2 - 2*t) * h * slope[i + 1];
+        }
+    };
+
+    /*!
+     * builds a table of crank2Stroke(deg + advance, stroke, length) - shift
+     * the piston uses advance = shift = 0, the valve uses the eccentric advance and half the valve travel
+     */
+    template <typename T, int N>
+    constexpr KinematicTable<T, N> makeKinematicTable(T stroke, T length, T advance, T shift)
+    {
+        KinematicTable<T, N> table{};
+        for (int i=0; i<=N; i++){
+            T deg = i * KinematicTable<T, N>::step() + advance;
+            table.value[i] = cx::crank2Stroke(deg, stroke, length) - shift;
+            table.slope[i] = cx::crank2StrokeSlope(deg, stroke, length);
+        }
+        return table;
+    }
+
+    /*!
+     * Table of SVE::crank2Stroke over a revolution for one (stroke, length) pair, built at runtime.
+     * Tables are shared through get(), so every engine with the same piston (stroke, conRod) or valve (valveTravel, valveConRod)
+     * dimensions uses the same table, and it is built only once. Building one costs about as much as 6000 direct evaluations,
+     * so tables are only worth it for bulk position queries (see SlideValveEngineT::prepareTables).
+     */
+    template <typename T>
+    class CrankTable
+    {
+    public:
+        static constexpr int steps = 1440;                             // quarter degree table
+
+        CrankTable(T stroke, T length);
+
+        T crank2Stroke(T deg) const;
+        T stroke2Crank(T pos, bool ret) const;
+        T stroke() const;
+        T length() const;
+        T maxError() const;                                         // largest difference from SVE::crank2Stroke measured between the table points
+        bool accurate() const;                                      // true if maxError() is small enough for the table to replace the direct calculation
+
+        static constexpr bool usable();                             // false if tables of <T> can never be accurate(), get() then builds nothing
+        static std::shared_ptr<const CrankTable<T>> get(T stroke, T length);   // shared accurate table for (stroke, length) built on first use, null if not accurate
+
+    private:
+        T _stroke;
+        T _length;
+        T _maxError;
+        KinematicTable<T, steps> _table;
+    };
+
+    extern template class CrankTable<float>;
+    extern template class CrankTable<double>;
+    extern template class CrankTable<long double>;
+}
+
+#endif // KINEMATICTABLE_H
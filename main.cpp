@@ -1,11 +1,46 @@
 #include "mainwindow.h"
+#include "tracing.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer startup;
+    startup.start();
+
+    // SVD_TRACE=<file> records a Chrome trace of the whole session
+    QString traceFile = qEnvironmentVariable("SVD_TRACE");
+    if (!traceFile.isEmpty())
+        Trace::start(traceFile);
+
     QApplication a(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Slide valve designer");
+    parser.addHelpOption();
+    QCommandLineOption timingOption("startup-timing", "Print the cold start times (ms) to stderr.");
+    parser.addOption(timingOption);
+    parser.process(a);
+    double application = startup.nsecsElapsed() * 1e-6;
+
     MainWindow w;
+    double window = startup.nsecsElapsed() * 1e-6;
+    double painted = 0;
+    if (parser.isSet(timingOption)){
+        QObject::connect(&w, &MainWindow::firstPainted, [&]{ painted = startup.nsecsElapsed() * 1e-6; });
+        QObject::connect(&w, &MainWindow::diagramsDrawn, [&]{
+            QTextStream(stderr) << "application " << application << " ms\n"
+                                << "window constructed " << window << " ms\n"
+                                << "first paint " << painted << " ms\n"
+                                << "diagrams drawn " << startup.nsecsElapsed() * 1e-6 << " ms\n";
+        });
+    }
     w.show();
-    return a.exec();
+    int ret = a.exec();
+
+    if (Trace::enabled())
+        Trace::stop();
+    return ret;
 }
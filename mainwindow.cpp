@@ -1,5 +1,19 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "steammap.h"
+#include "tracing.h"
+#include <QApplication>
+#include <QDockWidget>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QInputDialog>
+#include <QMessageBox>
+#include <QProgressDialog>
+#include <QTextStream>
+#include <QTimer>
+#include <QVBoxLayout>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -7,6 +21,7 @@ MainWindow::MainWindow(QWidget *parent)
 {
     tracerPlot_ = -1;
     _engine = new SlideValveEngine();
+    _engine->prepareTables();       // the plots and animation query many positions of the current design
     currentCrank_ = 0;
     ui->setupUi(this);
 
@@ -32,43 +47,187 @@ MainWindow::MainWindow(QWidget *parent)
 
     connect(ui->valvePlot, SIGNAL(Resized(QCustomPlot*, QSize)), this, SLOT(squarePlot(QCustomPlot*, QSize)));
 
+    // the valve diagram geometry that does not move with the crank keeps its own paint buffers (device pixel ratio aware),
+    // so moving the crank only redraws the "valveMoving" layer, see updateValveDiagram()
+    ui->valvePlot->addLayer("valveBackground", ui->valvePlot->layer("main"), QCustomPlot::limAbove);
+    ui->valvePlot->addLayer("valveMoving", ui->valvePlot->layer("valveBackground"), QCustomPlot::limAbove);
+    ui->valvePlot->addLayer("valveForeground", ui->valvePlot->layer("valveMoving"), QCustomPlot::limAbove);
+    ui->valvePlot->layer("valveBackground")->setMode(QCPLayer::lmBuffered);
+    ui->valvePlot->layer("valveMoving")->setMode(QCPLayer::lmBuffered);
+    ui->valvePlot->layer("valveForeground")->setMode(QCPLayer::lmBuffered);
+    connect(ui->actionExportFrames, SIGNAL(triggered()), this, SLOT(exportAnimationFrames()));
+    connect(ui->actionExportSteamMap, SIGNAL(triggered()), this, SLOT(exportSteamMap()));
+    connect(ui->actionRecordTrace, SIGNAL(toggled(bool)), this, SLOT(recordTrace(bool)));
+    connect(ui->actionPerformanceOverlay, SIGNAL(toggled(bool)), this, SLOT(showPerformanceOverlay(bool)));
+    connect(ui->actionUndo, SIGNAL(triggered()), this, SLOT(undoDesign()));
+    connect(ui->actionRedo, SIGNAL(triggered()), this, SLOT(redoDesign()));
+    connect(ui->actionSaveDesign, SIGNAL(triggered()), this, SLOT(saveDesign()));
+    connect(ui->actionLoadComparison, SIGNAL(triggered()), this, SLOT(loadComparison()));
+    connect(ui->actionClearComparison, SIGNAL(triggered()), this, SLOT(clearComparison()));
+    connect(ui->actionLoadKnownDesigns, SIGNAL(triggered()), this, SLOT(loadKnownDesigns()));
+    connect(ui->actionIndexSweep, SIGNAL(triggered()), this, SLOT(indexSweep()));
+    connect(ui->actionClearKnownDesigns, SIGNAL(triggered()), this, SLOT(clearKnownDesigns()));
+    ui->actionUndo->setShortcut(QKeySequence::Undo);
+    ui->actionRedo->setShortcut(QKeySequence::Redo);
+
+    // the starting design is the first history entry
+    DesignHistory::Entry initial;
+    initial.dims = SVE::designDims(_engine->getEngineParams());
+    initial.criticalPoints = _engine->criticalPoints();
+    history_.push(initial);
+    updateUndoActions();
+    ui->actionClearComparison->setEnabled(false);
+
+    // replot spans for the trace, connected first so they include everything else done before and after the replot
+    connect(ui->cyclePlot, &QCustomPlot::beforeReplot, []{ Trace::begin("cyclePlot replot"); });
+    connect(ui->cyclePlot, &QCustomPlot::afterReplot, []{ Trace::end("cyclePlot replot"); });
+    connect(ui->valvePlot, &QCustomPlot::beforeReplot, []{ Trace::begin("valvePlot replot"); });
+    connect(ui->valvePlot, &QCustomPlot::afterReplot, []{ Trace::end("valvePlot replot"); });
+    ui->actionRecordTrace->setChecked(Trace::enabled());
+
+    // performance overlays, hidden until turned on in the Tools menu
+    cycleHud_ = new PerfHud(ui->cyclePlot);
+    valveHud_ = new PerfHud(ui->valvePlot);
+
+    connect(ui->cyclePlot, SIGNAL(beforeReplot()), this, SLOT(refineCycleDiagram()));
+
+    // list of compared designs, the check box turns the region shading of a design on and off
+    comparisonList_ = new QListWidget();
+    comparisonDock_ = new QDockWidget("Compared Designs", this);
+    comparisonDock_->setWidget(comparisonList_);
+    addDockWidget(Qt::RightDockWidgetArea, comparisonDock_);
+    comparisonDock_->hide();
+    connect(comparisonList_, SIGNAL(itemChanged(QListWidgetItem*)), this, SLOT(comparisonItemChanged(QListWidgetItem*)));
+    ui->cyclePlot->yAxis2->setLabel("Valve Position (compared designs)");
+
+    // design space heatmap, built the first time its tab is opened. sweeps are varied from the current design
+    heatmap_ = nullptr;
+    heatmapTab_ = new QWidget();
+    QVBoxLayout *heatmapLayout = new QVBoxLayout(heatmapTab_);
+    heatmapLayout->setContentsMargins(0, 0, 0, 0);
+    ui->tabWidget->addTab(heatmapTab_, "Design Space");
+    connect(ui->tabWidget, SIGNAL(currentChanged(int)), this, SLOT(tabChanged(int)));
+
+    // dialogs are built the first time they are opened
+    bilgram_ = nullptr;
+    connect(ui->actionBilgramDiagram, SIGNAL(triggered()), this, SLOT(showBilgramDialog()));
+
+    // nearest known design, kept in the status bar next to the messages
+    knownDesignLabel_ = new QLabel();
+    ui->statusbar->addPermanentWidget(knownDesignLabel_);
+    ui->actionClearKnownDesigns->setEnabled(false);
+
+    // only the state is set here, the diagrams are drawn once the window has been painted (see eventFilter())
     ui->criticalPointSelect->setCurrentIndex(0);
-    setCriticalPoint(0);
+    setCurrentCrank(_engine->criticalPoints()[0]);
+    updateAnimationSlider(currentCrank_);
+    updateCurrentAngle(currentCrank_);
+    ui->cyclePlot->installEventFilter(this);
+}
+
+/*!
+ * waits for the first paint of the (still empty) cycle plot, then queues the diagram drawing behind it so the window
+ * shows without waiting for the curves
+ */
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == ui->cyclePlot && event->type() == QEvent::Paint){
+        ui->cyclePlot->removeEventFilter(this);
+        emit firstPainted();
+        QTimer::singleShot(0, this, SLOT(drawInitialDiagrams()));
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+/*!
+ * draws both diagrams of the starting design, one replot each
+ */
+void MainWindow::drawInitialDiagrams()
+{
+    TRACE_SCOPE("MainWindow::drawInitialDiagrams");
     tracerPlot_ = drawCycleDiagram();
     drawValveDiagram();
+    emit diagramsDrawn();
+}
+
+/*!
+ * builds the design space heatmap the first time its tab is opened
+ */
+void MainWindow::tabChanged(int index)
+{
+    if (heatmap_ || ui->tabWidget->widget(index) != heatmapTab_)
+        return;
+
+    TRACE_SCOPE("MainWindow::createHeatmap");
+    heatmap_ = new HeatmapView();
+    heatmap_->setBaseDesign(SVE::designDims(_engine->getEngineParams()));
+    heatmapTab_->layout()->addWidget(heatmap_);
+}
+
+/*!
+ * shows the Bilgram diagram dialog, built the first time it is opened
+ */
+void MainWindow::showBilgramDialog()
+{
+    if (!bilgram_)
+        bilgram_ = new BilgramDialog(this);
+    bilgram_->show();
+    bilgram_->raise();
+    bilgram_->activateWindow();
 }
 
 void MainWindow::updateEngineSettings()
 {
+    TRACE_SCOPE("MainWindow::updateEngineSettings");
+    applyDesign(designDims(), true);
+}
 
-    s_engineParams newSettings;
-    newSettings.bore = ui->bore->value();
-    newSettings.stroke = ui->stroke->value();
-    newSettings.conRod = ui->conRod->value();
-    newSettings.valveTravel = ui->valveTravel->value();
-    newSettings.valveConRod = ui->valveConRod->value();
-    newSettings.eccentricAdvance = ui->eccentricAdvance->value();
-    newSettings.valvePorts.topPort[0]  = -(ui->steamPortSpace->value() - ui->steamPortWidth->value()) / 2;
-    newSettings.valvePorts.botPort[0] = (ui->steamPortSpace->value() - ui->steamPortWidth->value()) / 2;
-    newSettings.valvePorts.exPort[0] = ui->exahustPortWidth->value() / 2;
-    newSettings.valvePorts.topPort[1] = -(ui->steamPortSpace->value() + ui->steamPortWidth->value()) / 2;
-    newSettings.valvePorts.botPort[1] = (ui->steamPortSpace->value() + ui->steamPortWidth->value()) / 2;
-    newSettings.valvePorts.exPort[1] = -ui->exahustPortWidth->value() / 2;
-    newSettings.valveSlide.topLand[0] = -ui->valveWidth->value()/2 + ui->valveTopLand->value();
-    newSettings.valveSlide.botLand[0] = (ui->valveWidth->value()/2) - ui->valveBottomLand->value();;
-    newSettings.valveSlide.topLand[1] = -ui->valveWidth->value()/2;
-    newSettings.valveSlide.botLand[1] = (ui->valveWidth->value()/2);
-
-    ErrorEnum ret = _engine->setEngineParams(newSettings);
+/*!
+ * sets the engine to a design and redraws
+ * \param dims      design dimensions
+ * \param record    true to add the design to the undo history if the engine accepts it
+ */
+void MainWindow::applyDesign(const s_designDims &dims, bool record)
+{
+    ErrorEnum ret = _engine->setEngineParams(SVE::designParams(dims));
     if (ret == ErrorEnum::none)
     {
         _settingsOK = true;
+        _engine->prepareTables();
+        if (record){
+            DesignHistory::Entry entry;
+            entry.dims = dims;
+            entry.criticalPoints = _engine->criticalPoints();
+            history_.push(entry);
+        }
+        if (heatmap_)
+            heatmap_->setBaseDesign(dims);
+        // background work (frame export) reads the accepted design from an immutable copy
+        enginePublisher_.publish(std::make_shared<const SlideValveEngine>(*_engine));
+
+        // warn about a narrow exahust port, the design is still usable
+        QStringList restricted;
+        for (bool ret : {false, true}){
+            s_exahustBottleneck bottleneck = _engine->exahustBottleneck(ret);
+            if (bottleneck.ratio < 1)
+                restricted << QString("%1 side %2 of port width at %3 deg").arg(ret ? "bottom" : "top")
+                              .arg(bottleneck.ratio, 0, 'f', 2).arg(bottleneck.crank, 0, 'f', 1);
+        }
+        if (restricted.isEmpty())
+            ui->statusbar->clearMessage();
+        else
+            ui->statusbar->showMessage("Exahust restricted: " + restricted.join(", "));
     }
     else
     {
         // Todo: error dialog
         _settingsOK = false;
     }
+    updateUndoActions();
+    updateKnownDesigns(dims);
+    // the static valve diagram geometry changed, the next valve diagram update rebuilds all of it
+    valveMovingCurves_.clear();
+
     if (ui->criticalPointSelect->currentIndex() != -1){
         tracerPlot_ = drawCycleDiagram();
         setCriticalPoint(ui->criticalPointSelect->currentIndex());
@@ -82,6 +241,75 @@ void MainWindow::updateEngineSettings()
     }
 }
 
+/*!
+ * design dimensions from the spin boxes
+ */
+s_designDims MainWindow::designDims() const
+{
+    s_designDims dims;
+    dims.bore = ui->bore->value();
+    dims.stroke = ui->stroke->value();
+    dims.conRod = ui->conRod->value();
+    dims.valveTravel = ui->valveTravel->value();
+    dims.valveConRod = ui->valveConRod->value();
+    dims.eccentricAdvance = ui->eccentricAdvance->value();
+    dims.steamPortWidth = ui->steamPortWidth->value();
+    dims.steamPortSpace = ui->steamPortSpace->value();
+    dims.exahustPortWidth = ui->exahustPortWidth->value();
+    dims.valveWidth = ui->valveWidth->value();
+    dims.valveTopLand = ui->valveTopLand->value();
+    dims.valveBottomLand = ui->valveBottomLand->value();
+    dims.topClearance = ui->topClearance->value();
+    dims.bottomClearance = ui->bottomClearance->value();
+    return dims;
+}
+
+/*!
+ * shows design dimensions in the spin boxes without triggering updateEngineSettings()
+ */
+void MainWindow::setDesignDims(const s_designDims &dims)
+{
+    const std::pair<QDoubleSpinBox*, double> values[] = {
+        {ui->bore, dims.bore}, {ui->stroke, dims.stroke}, {ui->conRod, dims.conRod},
+        {ui->valveTravel, dims.valveTravel}, {ui->valveConRod, dims.valveConRod}, {ui->eccentricAdvance, dims.eccentricAdvance},
+        {ui->steamPortWidth, dims.steamPortWidth}, {ui->steamPortSpace, dims.steamPortSpace}, {ui->exahustPortWidth, dims.exahustPortWidth},
+        {ui->valveWidth, dims.valveWidth}, {ui->valveTopLand, dims.valveTopLand}, {ui->valveBottomLand, dims.valveBottomLand},
+        {ui->topClearance, dims.topClearance}, {ui->bottomClearance, dims.bottomClearance}
+    };
+    for (const auto &value : values){
+        value.first->blockSignals(true);
+        value.first->setValue(value.second);
+        value.first->blockSignals(false);
+    }
+}
+
+/*!
+ * goes back to the previous accepted design. If the current settings are invalid (not in the history), goes back to the last accepted design
+ */
+void MainWindow::undoDesign()
+{
+    if (history_.isEmpty() || (_settingsOK && !history_.canUndo()))
+        return;
+    const DesignHistory::Entry &entry = _settingsOK ? history_.undo() : history_.current();
+    setDesignDims(entry.dims);
+    applyDesign(entry.dims, false);
+}
+
+void MainWindow::redoDesign()
+{
+    if (!history_.canRedo())
+        return;
+    const DesignHistory::Entry &entry = history_.redo();
+    setDesignDims(entry.dims);
+    applyDesign(entry.dims, false);
+}
+
+void MainWindow::updateUndoActions()
+{
+    ui->actionUndo->setEnabled(history_.canUndo() || (!_settingsOK && !history_.isEmpty()));
+    ui->actionRedo->setEnabled(history_.canRedo());
+}
+
 void MainWindow::updateCurrentAngle(double deg)
 {
     ui->currentAngle->blockSignals(true);
@@ -109,7 +337,7 @@ void MainWindow::sliderChanged(int value)
     setCurrentCrank((double)value);
     updateCriticalPoint(currentCrank_);
     updateCurrentAngle(currentCrank_);
-    drawValveDiagram();
+    updateValveDiagram();
     if (tracerPlot_ != -1){
         ui->cyclePlot->graph(tracerPlot_)->setData(QVector<double>{currentCrank_}, QVector<double>{_engine->crank2Stroke(currentCrank_)});
         ui->cyclePlot->replot();
@@ -121,7 +349,7 @@ void MainWindow::currentAngleChanged(double value)
     setCurrentCrank(value);
     updateAnimationSlider(value);
     updateCriticalPoint(value);
-    drawValveDiagram();
+    updateValveDiagram();
     if (tracerPlot_ != -1){
         ui->cyclePlot->graph(tracerPlot_)->setData(QVector<double>{currentCrank_}, QVector<double>{_engine->crank2Stroke(currentCrank_)});
         ui->cyclePlot->replot();
@@ -133,7 +361,7 @@ void MainWindow::setCriticalPoint(int value)
     setCurrentCrank(_engine->criticalPoints()[value]);
     updateAnimationSlider(currentCrank_);
     updateCurrentAngle(currentCrank_);
-    drawValveDiagram();
+    updateValveDiagram();
     if (tracerPlot_ != -1){
         ui->cyclePlot->graph(tracerPlot_)->setData(QVector<double>{currentCrank_}, QVector<double>{_engine->crank2Stroke(currentCrank_)});
         ui->cyclePlot->replot();
@@ -142,6 +370,7 @@ void MainWindow::setCriticalPoint(int value)
 
 void MainWindow::setCurrentCrank(double deg)
 {
+    TRACE_SCOPE("MainWindow::setCurrentCrank");
     currentCrank_ = deg;
     currentStroke_ = _engine->crank2Stroke(currentCrank_);
     currentValvePos_ = _engine->crank2ValvePos(currentCrank_);
@@ -152,6 +381,277 @@ void MainWindow::setCurrentCrank(double deg)
     ui->bottomCycle->setText(cycleNames_.find(currentBotCycle_)->second);
 }
 
+/*!
+ * asks for the frame count, format and directory, then renders animation frames of both diagrams in the background
+ */
+void MainWindow::exportAnimationFrames()
+{
+    if (!_settingsOK)
+        return;
+
+    bool ok;
+    int frames = QInputDialog::getInt(this, "Export Animation Frames", "Frames per revolution:", 360, 1, 36000, 1, &ok);
+    if (!ok)
+        return;
+    QString format = QInputDialog::getItem(this, "Export Animation Frames", "Image format:", QStringList{"PNG", "SVG"}, 0, false, &ok);
+    if (!ok)
+        return;
+    QString directory = QFileDialog::getExistingDirectory(this, "Export Animation Frames");
+    if (directory.isEmpty())
+        return;
+
+    // frames show the current view of each plot
+    AnimationExporter::View valveView{ui->valvePlot->xAxis->range(), ui->valvePlot->yAxis->range(), ui->valvePlot->axisRect()->size()};
+    AnimationExporter::View cycleView{ui->cyclePlot->xAxis->range(), ui->cyclePlot->yAxis->range(), ui->cyclePlot->axisRect()->size()};
+    if (valveView.size.isEmpty())
+        valveView.size = QSize(800, 800);
+    if (cycleView.size.isEmpty())
+        cycleView.size = QSize(1200, 600);
+
+    AnimationExporter *exporter = new AnimationExporter(enginePublisher_.snapshot(), _regionBrush, _thickPen, this);
+    QProgressDialog *progress = new QProgressDialog("Rendering animation frames...", "Cancel", 0, frames, this);
+    progress->setWindowModality(Qt::WindowModal);
+    connect(exporter, SIGNAL(frameFinished(int)), progress, SLOT(setValue(int)));
+    connect(progress, SIGNAL(canceled()), exporter, SLOT(cancel()));
+    connect(exporter, &AnimationExporter::failed, this, [this](QString error){
+        QMessageBox::warning(this, "Export Animation Frames", "The export stopped. " + error);
+    });
+    connect(exporter, SIGNAL(finished()), progress, SLOT(deleteLater()));
+    connect(exporter, SIGNAL(finished()), exporter, SLOT(deleteLater()));
+    exporter->start(valveView, cycleView, directory, frames, (format == "SVG") ? AnimationExporter::Format::svg : AnimationExporter::Format::png);
+}
+
+/*!
+ * asks for the speed range, then writes the speed corrected steam map of the current design (psi, inches, lb and hp) to a
+ * CSV file, one row per speed and chest pressure
+ */
+void MainWindow::exportSteamMap()
+{
+    if (!_settingsOK)
+        return;
+
+    bool ok;
+    int maxRpm = QInputDialog::getInt(this, "Export Steam Map", "Maximum speed (rpm):", 600, 10, 5000, 10, &ok);
+    if (!ok)
+        return;
+    QString fileName = QFileDialog::getSaveFileName(this, "Export Steam Map", "steammap.csv", "Steam maps (*.csv)");
+    if (fileName.isEmpty())
+        return;
+
+    // 12 speeds and chest pressures from 25 to 150 psig
+    SVE::SteamMapSettings settings = SVE::defaultSteamMapSettings();
+    std::vector<double> rpm;
+    for (int i=1; i<=12; i++)
+        rpm.push_back(maxRpm * i / 12.0);
+    std::vector<double> gauge;
+    std::vector<double> pressures;
+    for (int psig=25; psig<=150; psig+=25){
+        gauge.push_back(psig);
+        pressures.push_back(psig + settings.exahustPressure);
+    }
+
+    // a port flow run per grid point, a few hundred ms for the whole map
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    SVE::SteamMap map = SVE::speedCorrectedSteamMap(_engine->getEngineParams(), rpm, pressures, settings);
+    QApplication::restoreOverrideCursor();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)){
+        QMessageBox::warning(this, "Export Steam Map", "Could not save " + fileName + ": " + file.errorString());
+        return;
+    }
+    QTextStream out(&file);
+    out << "rpm,chestPressure_psig,steamPerRevolution_lb,indicatedWork_inlbf,indicatedPower_hp,steamRate_lb_h,waterRate_lb_hph\n";
+    for (int i=0; i<map.rpmCount; i++){
+        for (int j=0; j<map.pressureCount; j++){
+            int k = i * map.pressureCount + j;
+            out << rpm[i] << ',' << gauge[j] << ',' << map.steamPerRevolution[k] << ',' << map.indicatedWork[k] << ','
+                << map.indicatedPower[k] << ',' << map.steamRate[k] << ',' << map.waterRate[k] << '\n';
+        }
+    }
+    out.flush();
+    if (out.status() != QTextStream::Ok)
+        QMessageBox::warning(this, "Export Steam Map", "Could not save " + fileName + ": " + file.errorString());
+}
+
+/*!
+ * saves the current design to a CSV file, which can be loaded for comparison
+ */
+void MainWindow::saveDesign()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, "Save Design", "design.csv", "Designs (*.csv)");
+    if (fileName.isEmpty())
+        return;
+    DesignFile::Design design{QFileInfo(fileName).completeBaseName(), designDims()};
+    QString error;
+    if (!DesignFile::write(fileName, QVector<DesignFile::Design>{design}, &error))
+        QMessageBox::warning(this, "Save Design", "Could not save " + fileName + ": " + error);
+}
+
+/*!
+ * loads designs from CSV files and overlays them on the cycle diagram
+ */
+void MainWindow::loadComparison()
+{
+    QStringList fileNames = QFileDialog::getOpenFileNames(this, "Load Comparison Designs", QString(), "Designs (*.csv)");
+    if (fileNames.isEmpty())
+        return;
+
+    QVector<DesignFile::Design> designs;
+    for (const QString &fileName : fileNames){
+        QString error;
+        if (!DesignFile::read(fileName, designs, &error)){
+            QMessageBox::warning(this, "Load Comparison Designs", "Could not read " + fileName + ": " + error);
+            return;
+        }
+    }
+    comparison_.setDesigns(designs, -180, 440, 1240);
+
+    comparisonList_->blockSignals(true);
+    comparisonList_->clear();
+    for (int i=0; i<comparison_.size(); i++){
+        const DesignComparison::Design &design = comparison_.design(i);
+        QListWidgetItem *item = new QListWidgetItem(design.valid ? design.name : design.name + " (invalid)", comparisonList_);
+        item->setForeground(design.color);
+        item->setFlags(design.valid ? (Qt::ItemIsEnabled | Qt::ItemIsUserCheckable) : Qt::NoItemFlags);
+        item->setCheckState(Qt::Unchecked);
+    }
+    comparisonList_->blockSignals(false);
+    comparisonDock_->show();
+    ui->actionClearComparison->setEnabled(true);
+
+    tracerPlot_ = drawCycleDiagram();
+}
+
+void MainWindow::clearComparison()
+{
+    comparison_.clear();
+    comparisonList_->clear();
+    comparisonDock_->hide();
+    ui->actionClearComparison->setEnabled(false);
+    tracerPlot_ = drawCycleDiagram();
+}
+
+/*!
+ * loads designs from CSV files (saved designs or sweeps) to show as neighbours of the current design
+ */
+void MainWindow::loadKnownDesigns()
+{
+    QStringList fileNames = QFileDialog::getOpenFileNames(this, "Load Known Designs", QString(), "Designs (*.csv)");
+    if (fileNames.isEmpty())
+        return;
+
+    QVector<DesignFile::Design> designs;
+    for (const QString &fileName : fileNames){
+        QString error;
+        if (!DesignFile::read(fileName, designs, &error)){
+            QMessageBox::warning(this, "Load Known Designs", "Could not read " + fileName + ": " + error);
+            return;
+        }
+    }
+    setKnownDesigns(designs);
+}
+
+/*!
+ * uses the calculated points of the last design space sweep as the known designs
+ */
+void MainWindow::indexSweep()
+{
+    if (!heatmap_){
+        QMessageBox::information(this, "Known Designs", "There is no design space sweep yet.");
+        return;
+    }
+    if (heatmap_->sweep()->isRunning()){
+        QMessageBox::information(this, "Known Designs", "The design space sweep is still running.");
+        return;
+    }
+    setKnownDesigns(heatmap_->sweep()->designs());
+}
+
+void MainWindow::clearKnownDesigns()
+{
+    setKnownDesigns(QVector<DesignFile::Design>());
+}
+
+void MainWindow::setKnownDesigns(const QVector<DesignFile::Design> &designs)
+{
+    knownDesigns_.build(designs);
+    ui->actionClearKnownDesigns->setEnabled(knownDesigns_.size() > 0);
+    updateKnownDesigns(designDims());
+}
+
+/*!
+ * shows the known design nearest to <dims>, and how many known designs have a cutoff within 1 degree of the current one
+ * (the index answers both without evaluating anything, so this runs on every spin box change)
+ */
+void MainWindow::updateKnownDesigns(const s_designDims &dims)
+{
+    if (knownDesigns_.size() == 0){
+        knownDesignLabel_->clear();
+        return;
+    }
+
+    double distance;
+    const DesignFile::Design &nearest = knownDesigns_.design(knownDesigns_.nearest(dims, &distance));
+    QString text = QString("Nearest known: %1 (%2)").arg(nearest.name).arg(distance, 0, 'f', 3);
+    if (_settingsOK){
+        double cutoff = _engine->crankCutoff(false);
+        int similar = knownDesigns_.criticalPointWindow(1, cutoff, 1.0).size();
+        text += QString(", %1 with cutoff %2 +-1 deg").arg(similar).arg(cutoff, 0, 'f', 1);
+    }
+    knownDesignLabel_->setText(text);
+}
+
+/*!
+ * turns region shading of a compared design on or off when its check box changes
+ */
+void MainWindow::comparisonItemChanged(QListWidgetItem *item)
+{
+    int i = comparisonList_->row(item);
+    if (i < 0 || i >= comparison_.size())
+        return;
+    comparison_.setShaded(i, item->checkState() == Qt::Checked, cycleResolution(QCPRange(-180, 440), QCPRange(0, _engine->getEngineParams().stroke)));
+    tracerPlot_ = drawCycleDiagram();
+}
+
+/*!
+ * starts or stops recording a Chrome trace of the GUI updates
+ * \param record    true to ask for a file and start recording, false to stop and write the file
+ */
+void MainWindow::recordTrace(bool record)
+{
+    if (record == Trace::enabled())
+        return;
+
+    if (record){
+        QString fileName = QFileDialog::getSaveFileName(this, "Record Trace", "slideValveDesigner.trace.json", "Chrome trace (*.json)");
+        if (fileName.isEmpty() || !Trace::start(fileName)){
+            ui->actionRecordTrace->blockSignals(true);
+            ui->actionRecordTrace->setChecked(false);
+            ui->actionRecordTrace->blockSignals(false);
+            return;
+        }
+        ui->statusbar->showMessage("Recording trace to " + fileName);
+    }else{
+        QString fileName = Trace::fileName();
+        if (Trace::stop())
+            ui->statusbar->showMessage("Trace written to " + fileName);
+        else
+            ui->statusbar->showMessage("Could not write trace file " + fileName);
+    }
+}
+
+/*!
+ * shows or hides the performance overlay on both plots
+ */
+void MainWindow::showPerformanceOverlay(bool show)
+{
+    cycleHud_->setVisible(show);
+    valveHud_->setVisible(show);
+    ui->cyclePlot->replot();
+    ui->valvePlot->replot();
+}
+
 void MainWindow::squarePlot(QCustomPlot *plot, QSize s)
 {
     if (s.height() > s.width())
@@ -164,156 +664,95 @@ void MainWindow::squarePlot(QCustomPlot *plot, QSize s)
 /*********************************** Methods which draw diagrams ***************************************************************************************/
 void MainWindow::drawValveDiagram()
 {
+    TRACE_SCOPE("MainWindow::drawValveDiagram");
     ui->valvePlot->clearGraphs();
     ui->valvePlot->clearItems();
     ui->valvePlot->clearPlottables();
+    valveMovingCurves_.clear();
 
     if (_settingsOK)
     {
-       // calculate some drawing parameters so the diagram looks nice
-       // Note 0,0 is the center of the valve face, and the cylinder axis is below the Y axis
-       auto params = _engine->getEngineParams();
-       double topPortWidth = params.valvePorts.topPort[0] - params.valvePorts.topPort[1];   // width of the top steam port
-       double botPortWidth = params.valvePorts.botPort[1] - params.valvePorts.botPort[0];   // width of the bottom steam port
-       double valveSizeParameter = params.valveTravel / 4;                                  // atomic unit for drawing the valve and steam chest heights
-       double pistonWidth = params.bore / 8;                                                  // width of piston width/piston rod and outer walls
-       if (pistonWidth < 1.5*valveSizeParameter)
-           pistonWidth = 1.5*valveSizeParameter;
-       double outsideEdge = pistonWidth + (params.stroke + pistonWidth)/2;                            // make the outside edge 1 piston width larger than the stroke on each side
-       double insideEdge = outsideEdge - pistonWidth;
-       double steamChestTop = 4*valveSizeParameter;
-       double topEdge = steamChestTop + pistonWidth;
-       double portWall = 3 * ((topPortWidth > botPortWidth) ? topPortWidth : botPortWidth); // wall between the cylinder bore and valve face = 3 time larger port
-       double cylinderBottom = -portWall - params.bore;
-       double bottomEdge = cylinderBottom - pistonWidth;
-
-       // draw cylinder1
-       QCPCurve *cylinder1 = new QCPCurve(ui->valvePlot->xAxis, ui->valvePlot->yAxis);
-       cylinder1->data()->set(drawCylinder1(outsideEdge, insideEdge, bottomEdge, topEdge, portWall, pistonWidth));
-       cylinder1->setBrush(QBrush(QColor(0,0,0,255)));
-
-       QCPCurve *forwardShade = new QCPCurve(ui->valvePlot->xAxis, ui->valvePlot->yAxis);
-       forwardShade->data()->set(drawForwardShade(currentStroke_, insideEdge, portWall, cylinderBottom, pistonWidth));
-       forwardShade->setBrush(_regionBrush[currentTopCycle_]);
-       forwardShade->setPen(QPen(QColor(0,0,0,0)));
-
-       QCPCurve *reverseShade = new QCPCurve(ui->valvePlot->xAxis, ui->valvePlot->yAxis);
-       reverseShade->data()->set(drawReverseShade(currentStroke_, insideEdge, portWall, cylinderBottom, pistonWidth));
-       reverseShade->setBrush(_regionBrush[currentBotCycle_]);
-       reverseShade->setPen(QPen(QColor(0,0,0,0)));
-
-       QCPCurve *piston = new QCPCurve(ui->valvePlot->xAxis, ui->valvePlot->yAxis);
-       piston->data()->set(drawPiston(currentStroke_, portWall, cylinderBottom, pistonWidth));
-       piston->setBrush(QBrush(QColor(150,150,150,255)));
-
-       QCPCurve *steamChestShade = new QCPCurve(ui->valvePlot->xAxis, ui->valvePlot->yAxis);
-       steamChestShade->data()->set(drawSteamChestShade(insideEdge, steamChestTop));
-       steamChestShade->setBrush(_regionBrush[CycleEnum::intake]);  // steam chest is always full of full pressure steam
-       steamChestShade->setPen(QPen(QColor(0,0,0,0)));
-
-       QCPCurve *exahustShade = new QCPCurve(ui->valvePlot->xAxis, ui->valvePlot->yAxis);
-       exahustShade->data()->set(drawExahustShade(portWall));
-       exahustShade->setBrush(_regionBrush[CycleEnum::exahust]);  // steam chest is always full of full pressure steam
-       exahustShade->setPen(QPen(QColor(0,0,0,0)));
-
-      // draw slide valve curve
-      QCPCurve *slideValve = new QCPCurve(ui->valvePlot->xAxis, ui->valvePlot->yAxis);
-      slideValve->data()->set(drawSlide(currentValvePos_, valveSizeParameter));
-      slideValve->setBrush(QBrush(QColor(150,150,150,255)));
-
-      QCPCurve *valveShade = new QCPCurve(ui->valvePlot->xAxis, ui->valvePlot->yAxis);
-      valveShade->data()->set(drawValveShade(currentValvePos_, valveSizeParameter));
-      valveShade->setBrush(_regionBrush[CycleEnum::exahust]);
-      valveShade->setPen(QPen(QColor(0,0,0,0)));
-
-      // draw cylinder2
-      QCPCurve *cylinder2 = new QCPCurve(ui->valvePlot->xAxis, ui->valvePlot->yAxis);
-      cylinder2->data()->set(drawCylinder2(portWall, insideEdge));
-      cylinder2->setBrush(QBrush(QColor(0,0,0,255)));
+        ValveDiagram diagram(_engine->getEngineParams(), _regionBrush);
+        auto addShapes = [this](QVector<ValveDiagram::Shape> shapes, const QString &layer, QVector<QCPCurve*> *curves) {
+            for (ValveDiagram::Shape &shape : shapes)
+            {
+                QCPCurve *curve = new QCPCurve(ui->valvePlot->xAxis, ui->valvePlot->yAxis);
+                curve->setLayer(layer);
+                curve->data()->adopt(std::move(shape.data));
+                curve->setBrush(shape.brush);
+                curve->setPen(shape.pen);
+                if (curves)
+                    curves->append(curve);
+            }
+        };
+        addShapes(diagram.backgroundShapes(), "valveBackground", nullptr);
+        addShapes(diagram.movingShapes(currentStroke_, currentValvePos_, currentTopCycle_, currentBotCycle_), "valveMoving", &valveMovingCurves_);
+        addShapes(diagram.foregroundShapes(), "valveForeground", nullptr);
     }
     else
     {
         // todo put text on plot indicating invalid settings
     }
-    ui->valvePlot->replot();
+    // squarePlot() replots
     squarePlot(ui->valvePlot, ui->valvePlot->size());
 }
 
+/*!
+ * moves the valve diagram to the current crank position. Only the moving shapes are regenerated and only their layer is
+ * redrawn, the static geometry stays in its paint buffers. Falls back to drawValveDiagram() when there is nothing to move
+ * (invalid design, or the design changed since the last full draw)
+ */
+void MainWindow::updateValveDiagram()
+{
+    TRACE_SCOPE("MainWindow::updateValveDiagram");
+    if (valveMovingCurves_.isEmpty()){
+        drawValveDiagram();
+        return;
+    }
+
+    ValveDiagram diagram(_engine->getEngineParams(), _regionBrush);
+    QVector<ValveDiagram::Shape> shapes = diagram.movingShapes(currentStroke_, currentValvePos_, currentTopCycle_, currentBotCycle_);
+    for (int i=0; i<shapes.size() && i<valveMovingCurves_.size(); i++){
+        valveMovingCurves_[i]->data()->adopt(std::move(shapes[i].data));
+        valveMovingCurves_[i]->setBrush(shapes[i].brush);
+    }
+    // a layer replot does not emit the plot's replot signals, so the overlay is told about it here
+    QElapsedTimer replotTimer;
+    replotTimer.start();
+    ui->valvePlot->layer("valveMoving")->replot();
+    valveHud_->recordReplot(replotTimer.nsecsElapsed() / 1e6);
+    if (valveHud_->visible())
+        ui->valvePlot->layer("overlay")->replot();
+}
+
 int MainWindow::drawCycleDiagram()
 {
+    TRACE_SCOPE("MainWindow::drawCycleDiagram");
     ui->cyclePlot->clearGraphs();
     ui->cyclePlot->clearItems();
     if (_settingsOK)
     {
-        double stroke = _engine->getEngineParams().stroke;
-
-        // draw shaded regions from <stroke> to the X-Axis for the bottom port regions
-        // these will be over-drawn by the position curve
+        // draw the shaded regions. the bottom port regions come first, so they are over-drawn by the position curve
         int graphIndex = -1;            // for counting graphs
-        double crankPos = -180;
-        double crankStop = 440;
-
-        // get the critical points
-        auto foo = _engine->botCriticalPoints();
-        //find the index of the first point after the starting position
-        int nextIndex = _engine->nextBotCriticalPoint(crankPos);
-        while (crankPos < crankStop)
-        {
-            // make graph from crank position to next critical point (or end whichever comes first)
-            ui->cyclePlot->addGraph();      // add graph
-            graphIndex++;                   // count it
-            double diff = SVE::addAngles(foo[nextIndex], -crankPos);
-            if (diff < 0)
-                diff +=360;
-            double nextCrankPos = crankPos + diff;
-            if (++nextIndex ==4)
-                    nextIndex = 0;
-            // set the fill color based on region
-            CycleEnum cycle = _engine->crank2BotCycle((crankPos+nextCrankPos)/2);
-            if (nextCrankPos > crankStop)
-               nextCrankPos = crankStop;
-            ui->cyclePlot->graph(graphIndex)->setBrush(_regionBrush[cycle]);
-            QVector<double> rX(2), rY(2);
-            rX[0] = crankPos;
-            rY[0] = stroke;
-            rX[1] = nextCrankPos;
-            rY[1] = stroke;
-            ui->cyclePlot->graph(graphIndex)->setData(rX, rY);
-            crankPos = nextCrankPos;
+        // sampled for the whole diagram, rescaleAxes() below shows all of it
+        cycleResolution_ = cycleResolution(QCPRange(-180, 440), QCPRange(0, _engine->getEngineParams().stroke));
+        // redisplaying a design from the undo history reuses its curves
+        DesignHistory::CycleCurves segments = history_.cycleCurves(cycleResolution_);
+        if (!segments){
+            segments = std::make_shared<const QVector<CycleDiagram::Segment>>(CycleDiagram::segments(*_engine, -180, 440, cycleResolution_));
+            history_.setCycleCurves(segments, cycleResolution_);
         }
-
-        crankPos = -180;
-        foo = _engine->topCriticalPoints();
-        nextIndex = _engine->nextTopCriticalPoint(crankPos);
-        while (crankPos < crankStop)
+        cycleGraphs_.clear();
+        for (const CycleDiagram::Segment &segment : *segments)
         {
-            // make graph from crank position to next critical point (or end whichever comes first)
             ui->cyclePlot->addGraph();      // add graph
             graphIndex++;                   // count it
-            double diff = SVE::addAngles(foo[nextIndex], -crankPos);
-            if (diff < 0)
-                diff +=360;
-            double nextCrankPos = crankPos + diff;
-            if (++nextIndex ==4)
-                    nextIndex = 0;
-            // set the fill color based on region
-            CycleEnum cycle = _engine->crank2TopCycle((crankPos + nextCrankPos) / 2);
-            if (nextCrankPos > crankStop)
-                nextCrankPos = crankStop;
-            ui->cyclePlot->graph(graphIndex)->setPen(_thickPen);
-            ui->cyclePlot->graph(graphIndex)->setBrush(_regionBrush[cycle]);
-            QVector<double> fX, fY;
-            fX.append(crankPos);
-            fY.append(_engine->crank2Stroke(crankPos));
-            for (int step=0; crankPos < nextCrankPos; step++)
-            {
-                crankPos += .01;                // step the position
-                if (crankPos > nextCrankPos)    // check for overshoot
-                    crankPos = nextCrankPos;
-                fX.append(crankPos);
-                fY.append(_engine->crank2Stroke(crankPos));
-            }
-            ui->cyclePlot->graph(graphIndex)->setData(fX, fY);
+            cycleGraphs_.append(ui->cyclePlot->graph(graphIndex));
+            if (segment.top)
+                ui->cyclePlot->graph(graphIndex)->setPen(_thickPen);
+            ui->cyclePlot->graph(graphIndex)->setBrush(_regionBrush[segment.cycle]);
+            // shares the (possibly cached) segment buffer, no copy or sort
+            ui->cyclePlot->graph(graphIndex)->data()->set(segment.data, true);
         }
 
         // Add tracer Graph
@@ -322,183 +761,109 @@ int MainWindow::drawCycleDiagram()
         ui->cyclePlot->graph(graphIndex)->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, Qt::red, Qt::white, 10));
         ui->cyclePlot->graph(graphIndex)->setData(QVector<double>{currentCrank_}, QVector<double>{_engine->crank2Stroke(currentCrank_)});
 
+        // compared designs go over the current design. Added after the tracer so its index is unchanged
+        drawComparison();
+
         ui->cyclePlot->rescaleAxes();
         ui->cyclePlot->replot();
         return graphIndex;
     }
     else
     {
+        cycleGraphs_.clear();
         // todo put text on plot indicating invalid settings
         ui->cyclePlot->replot();
         return -1;
     }    
 }
-/********************************* methods to generate graphical paths for the simulation diagram ******************************************************/
-
-QCPDataContainer<QCPCurveData> MainWindow::drawSlide(double offset, double sizeParam){
-    QCPDataContainer<QCPCurveData> data;
-    auto params = _engine->getEngineParams();
-    int pointIndex = 0;
-    data.add(QCPCurveData(pointIndex++, offset + params.valveSlide.topLand[1], 0));
-    data.add(QCPCurveData(pointIndex++, offset + params.valveSlide.topLand[1], 2*sizeParam));
-    data.add(QCPCurveData(pointIndex++, offset + params.valveSlide.botLand[1], 2*sizeParam));
-    data.add(QCPCurveData(pointIndex++, offset + params.valveSlide.botLand[1], 0));
-    data.add(QCPCurveData(pointIndex++, offset + params.valveSlide.botLand[0], 0));
-    data.add(QCPCurveData(pointIndex++, offset + params.valveSlide.botLand[0], sizeParam));
-    data.add(QCPCurveData(pointIndex++, offset + params.valveSlide.topLand[0], sizeParam));
-    data.add(QCPCurveData(pointIndex++, offset + params.valveSlide.topLand[0], 0));
-    data.add(QCPCurveData(pointIndex++, offset + params.valveSlide.topLand[1], 0));
-    return data;
-}
-
-QCPDataContainer<QCPCurveData> MainWindow::drawCylinder1(double outsideEdge, double insideEdge, double bottomEdge, double topEdge, double portWall, double piston){
-    QCPDataContainer<QCPCurveData> data;
-    auto params = _engine->getEngineParams();
-    double axis = -portWall - params.bore / 2;
-    double portWidth = portWall / 3;
-    int pointIndex = 0;
-    data.add(QCPCurveData(pointIndex++, -outsideEdge, bottomEdge));
-    data.add(QCPCurveData(pointIndex++, -outsideEdge, topEdge));
-    data.add(QCPCurveData(pointIndex++, outsideEdge, topEdge));
-    data.add(QCPCurveData(pointIndex++, outsideEdge, axis + piston / 2));
-    data.add(QCPCurveData(pointIndex++, insideEdge, axis + piston / 2));
-    data.add(QCPCurveData(pointIndex++, insideEdge, -portWidth ));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.botPort[1], -portWidth));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.botPort[1], 0));
-    data.add(QCPCurveData(pointIndex++, insideEdge, 0));
-    data.add(QCPCurveData(pointIndex++, insideEdge, topEdge - piston));
-    data.add(QCPCurveData(pointIndex++, -insideEdge, topEdge - piston));
-    data.add(QCPCurveData(pointIndex++, -insideEdge, 0));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.topPort[1], 0));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.topPort[1], -portWidth));
-    data.add(QCPCurveData(pointIndex++, -insideEdge, -portWidth));
-    data.add(QCPCurveData(pointIndex++, -insideEdge, axis - params.bore / 2));
-    data.add(QCPCurveData(pointIndex++, insideEdge, axis - params.bore / 2));
-    data.add(QCPCurveData(pointIndex++, insideEdge, axis - piston/2));
-    data.add(QCPCurveData(pointIndex++, outsideEdge, axis - piston/2));
-    data.add(QCPCurveData(pointIndex++, outsideEdge, bottomEdge));
-    data.add(QCPCurveData(pointIndex++, -outsideEdge, bottomEdge));
-
-
-    return data;
-}
-
-QCPDataContainer<QCPCurveData> MainWindow::drawCylinder2(double portWall, double insideEdge){
-    QCPDataContainer<QCPCurveData> data;
-    auto params = _engine->getEngineParams();
-    double portWidth = portWall / 3;
-    int pointIndex = 0;
-    data.add(QCPCurveData(pointIndex++, -insideEdge + portWidth, -portWall));
-    data.add(QCPCurveData(pointIndex++, -insideEdge + portWidth, -portWall + portWidth));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.topPort[0], -portWall + portWidth));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.topPort[0], 0));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.exPort[1], 0));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.exPort[1], -2*portWidth));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.exPort[0], -2*portWidth));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.exPort[0], 0));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.botPort[0], 0));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.botPort[0], -portWall + portWidth));
-    data.add(QCPCurveData(pointIndex++, insideEdge - portWidth , -portWall + portWidth));
-    data.add(QCPCurveData(pointIndex++, insideEdge - portWidth , -portWall));
-    data.add(QCPCurveData(pointIndex++, -insideEdge + portWidth, -portWall));
-    return data;
-}
-
-QCPDataContainer<QCPCurveData> MainWindow::drawPiston(double stroke, double portWall, double cylinderBottom, double pistonWidth){
-    QCPDataContainer<QCPCurveData> data;
-    auto params = _engine->getEngineParams();
-    double axis = (-portWall + cylinderBottom) / 2;
-    double leftEdge = -(params.stroke / 2) - pistonWidth/2;
-    int pointIndex = 0;
-    data.add(QCPCurveData(pointIndex++, stroke + leftEdge, cylinderBottom));
-    data.add(QCPCurveData(pointIndex++, stroke + leftEdge, -portWall));
-    data.add(QCPCurveData(pointIndex++, stroke + leftEdge + pistonWidth, -portWall));
-    data.add(QCPCurveData(pointIndex++, stroke + leftEdge + pistonWidth, axis + pistonWidth/2));
-    data.add(QCPCurveData(pointIndex++, stroke + leftEdge + 4*pistonWidth + params.stroke, axis + pistonWidth/2));
-    data.add(QCPCurveData(pointIndex++, stroke + leftEdge + 4*pistonWidth + params.stroke, axis - pistonWidth/2));
-    data.add(QCPCurveData(pointIndex++, stroke + leftEdge + pistonWidth, axis - pistonWidth/2));
-    data.add(QCPCurveData(pointIndex++, stroke + leftEdge + pistonWidth, cylinderBottom));
-    data.add(QCPCurveData(pointIndex++, stroke + leftEdge, cylinderBottom));
-    return data;
-}
-
-QCPDataContainer<QCPCurveData> MainWindow::drawForwardShade(double stroke, double insideEdge, double portWall, double cylinderBottom, double pistonWidth){
-    QCPDataContainer<QCPCurveData> data;
-    auto params = _engine->getEngineParams();
-    double portWidth = portWall / 3;;
-    double leftEdge = -(params.stroke / 2) - pistonWidth/2;
-    int pointIndex = 0;
-    data.add(QCPCurveData(pointIndex++, -insideEdge, cylinderBottom));
-    data.add(QCPCurveData(pointIndex++, -insideEdge, -portWidth));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.topPort[1], -portWidth));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.topPort[1], 0));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.topPort[0], 0));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.topPort[0], -2*portWidth));
-    data.add(QCPCurveData(pointIndex++, -insideEdge + portWidth, -2*portWidth));
-    data.add(QCPCurveData(pointIndex++, -insideEdge + portWidth, -portWall));
-    data.add(QCPCurveData(pointIndex++, stroke + leftEdge, -portWall));
-    data.add(QCPCurveData(pointIndex++, stroke + leftEdge, cylinderBottom));
-    data.add(QCPCurveData(pointIndex++, -insideEdge, cylinderBottom));
-    return data;
-}
-
-QCPDataContainer<QCPCurveData> MainWindow::drawReverseShade(double stroke, double insideEdge, double portWall, double cylinderBottom, double pistonWidth){
-    QCPDataContainer<QCPCurveData> data;
-    auto params = _engine->getEngineParams();
-    double portWidth = portWall / 3;
-    double rightEdge = -(params.stroke / 2) + pistonWidth/2;
-    int pointIndex = 0;
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.botPort[0], 0));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.botPort[1], 0));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.botPort[1], -portWidth));
-    data.add(QCPCurveData(pointIndex++, insideEdge, -portWidth));
-    data.add(QCPCurveData(pointIndex++, insideEdge, cylinderBottom));
-    data.add(QCPCurveData(pointIndex++, stroke + rightEdge, cylinderBottom));
-    data.add(QCPCurveData(pointIndex++, stroke + rightEdge, -portWall));
-    data.add(QCPCurveData(pointIndex++, insideEdge - portWidth, -portWall));
-    data.add(QCPCurveData(pointIndex++, insideEdge - portWidth, -2*portWidth));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.botPort[0], -2*portWidth));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.botPort[0], 0));
-    return data;
-}
-
-QCPDataContainer<QCPCurveData> MainWindow::drawValveShade(double offset, double sizeParam){
-    QCPDataContainer<QCPCurveData> data;
-    auto params = _engine->getEngineParams();
-    int pointIndex = 0;
-    data.add(QCPCurveData(pointIndex++, offset + params.valveSlide.botLand[0], 0));
-    data.add(QCPCurveData(pointIndex++, offset + params.valveSlide.topLand[0], 0));
-    data.add(QCPCurveData(pointIndex++, offset + params.valveSlide.topLand[0], sizeParam));
-    data.add(QCPCurveData(pointIndex++, offset + params.valveSlide.botLand[0], sizeParam));
-    data.add(QCPCurveData(pointIndex++, offset + params.valveSlide.botLand[0], 0));
-    return data;
-}
-
-QCPDataContainer<QCPCurveData> MainWindow::drawSteamChestShade(double insideEdge, double steamChestTop){
-    QCPDataContainer<QCPCurveData> data;
-    int pointIndex = 0;
-    data.add(QCPCurveData(pointIndex++, -insideEdge, 0));
-    data.add(QCPCurveData(pointIndex++, -insideEdge, steamChestTop));
-    data.add(QCPCurveData(pointIndex++, insideEdge, steamChestTop));
-    data.add(QCPCurveData(pointIndex++, insideEdge, 0));
-    data.add(QCPCurveData(pointIndex++, -insideEdge, 0));
-    return data;
-}
-
-QCPDataContainer<QCPCurveData> MainWindow::drawExahustShade(double portWall){
-    QCPDataContainer<QCPCurveData> data;
-    auto params = _engine->getEngineParams();
-    double portWidth = portWall / 3;
-    int pointIndex = 0;
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.exPort[0], 0));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.exPort[1], 0));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.exPort[1], -2*portWidth));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.exPort[0], -2*portWidth));
-    data.add(QCPCurveData(pointIndex++, params.valvePorts.exPort[0], 0));
-
-    return data;
+
+/*!
+ * adds the compared designs to the cycle diagram: region shading (if turned on), piston curve, critical points, and valve position on the right axis
+ * the curve data is shared with comparison_, so this does not copy it
+ */
+void MainWindow::drawComparison()
+{
+    TRACE_SCOPE("MainWindow::drawComparison");
+    ui->cyclePlot->yAxis2->setVisible(!comparison_.isEmpty());
+    for (int i=0; i<comparison_.size(); i++){
+        const DesignComparison::Design &design = comparison_.design(i);
+        if (!design.valid)
+            continue;
+
+        if (design.shaded){
+            for (const CycleDiagram::Segment &segment : design.regions){
+                QCPGraph *region = ui->cyclePlot->addGraph();
+                QColor color = _regionBrush[segment.cycle].color();
+                color.setAlpha(60);
+                region->setBrush(color);
+                region->setPen(segment.top ? QPen(design.color, 1) : QPen(Qt::NoPen));
+                region->data()->set(segment.data, true);
+            }
+        }
+
+        QCPGraph *stroke = ui->cyclePlot->addGraph();
+        stroke->setPen(QPen(design.color, 1.5));
+        stroke->setName(design.name);
+        stroke->setData(design.stroke);
+
+        QCPGraph *events = ui->cyclePlot->addGraph();
+        events->setLineStyle(QCPGraph::lsNone);
+        events->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDiamond, design.color, design.color, 7));
+        events->setData(design.events);
+
+        QCPGraph *valvePos = ui->cyclePlot->addGraph(ui->cyclePlot->xAxis, ui->cyclePlot->yAxis2);
+        valvePos->setPen(QPen(design.color, 1, Qt::DashLine));
+        valvePos->setData(design.valvePos);
+    }
+}
+
+/*!
+ * sampling resolution for the cycle diagram when showing <xView> and <yView>
+ * \param xView     visible crank range
+ * \param yView     visible stroke range
+ * \return pixel scales for the visible range (with a margin for panning) and for the whole diagram
+ */
+SVE::SampleResolution<double> MainWindow::cycleResolution(QCPRange xView, QCPRange yView)
+{
+    // before the window is shown the axis rect has no size yet, assume a reasonable one
+    QRect rect = ui->cyclePlot->axisRect()->rect();
+    double width = qMax(rect.width(), 400);
+    double height = qMax(rect.height(), 300);
+
+    SVE::SampleResolution<double> resolution;
+    resolution.viewLower = xView.lower - xView.size() / 2;
+    resolution.viewUpper = xView.upper + xView.size() / 2;
+    resolution.viewXScale = width / xView.size();
+    resolution.viewYScale = height / yView.size();
+    resolution.xScale = width / 620.0;
+    resolution.yScale = height / _engine->getEngineParams().stroke;
+    resolution.tolerance = 0.25;
+    return resolution;
 }
 
+/*!
+ * resamples the cycle diagram curves when the plot is zoomed in (or moved past the refined range) far enough that the current samples would show
+ * called before every replot of the cycle diagram, the curves are only resampled if needed
+ */
+void MainWindow::refineCycleDiagram()
+{
+    if (!_settingsOK || cycleGraphs_.isEmpty())
+        return;
+
+    QCPRange xView = ui->cyclePlot->xAxis->range();
+    QCPRange yView = ui->cyclePlot->yAxis->range();
+    SVE::SampleResolution<double> needed = cycleResolution(xView, yView);
+    const double slack = 0.7;       // resample once the samples are more than 1/0.7 times too coarse for the view
+    if (xView.lower >= cycleResolution_.viewLower && xView.upper <= cycleResolution_.viewUpper
+            && cycleResolution_.viewXScale >= slack * needed.viewXScale && cycleResolution_.viewYScale >= slack * needed.viewYScale
+            && cycleResolution_.xScale >= slack * needed.xScale && cycleResolution_.yScale >= slack * needed.yScale)
+        return;
+
+    cycleResolution_ = needed;
+    QVector<CycleDiagram::Segment> segments = CycleDiagram::segments(*_engine, -180, 440, cycleResolution_);
+    for (int i=0; i<segments.size() && i<cycleGraphs_.size(); i++)
+        cycleGraphs_[i]->data()->adopt(std::move(segments[i].data));
+}
 MainWindow::~MainWindow()
 {
     delete ui;
@@ -3,8 +3,20 @@
 
 #include <QMainWindow>
 #include <QGraphicsScene>
+#include <QLabel>
+#include <QListWidget>
 #include "qcustomplot.h"
 #include "slidevalveengine.h"
+#include "animationexporter.h"
+#include "bilgramdialog.h"
+#include "cyclediagram.h"
+#include "designcomparison.h"
+#include "designhistory.h"
+#include "designindex.h"
+#include "enginesnapshot.h"
+#include "heatmapview.h"
+#include "perfhud.h"
+#include "valvediagram.h"
 
 
 QT_BEGIN_NAMESPACE
@@ -19,6 +31,12 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+signals:
+    void firstPainted();                                    // the window has been shown, diagrams not drawn yet
+    void diagramsDrawn();                                   // the starting design has been drawn
+
     private slots:                
         void updateEngineSettings();
         void drawValveDiagram();        
@@ -26,10 +44,28 @@ public:
         void currentAngleChanged(double value);
         void setCriticalPoint(int value);
         void squarePlot(QCustomPlot *plot, QSize s);
+        void exportAnimationFrames();
+        void exportSteamMap();
+        void refineCycleDiagram();
+        void recordTrace(bool record);
+        void showPerformanceOverlay(bool show);
+        void undoDesign();
+        void redoDesign();
+        void saveDesign();
+        void loadComparison();
+        void clearComparison();
+        void comparisonItemChanged(QListWidgetItem *item);
+        void loadKnownDesigns();
+        void indexSweep();
+        void clearKnownDesigns();
+        void drawInitialDiagrams();
+        void tabChanged(int index);
+        void showBilgramDialog();
 
 private:
     Ui::MainWindow *ui;
     SlideValveEngine *_engine;
+    SVE::EnginePublisher<double> enginePublisher_;           // last accepted design, for worker threads
     double currentCrank_;                                   // holds current crank position for interactive plots
     CycleEnum currentTopCycle_;
     CycleEnum currentBotCycle_;
@@ -40,6 +76,21 @@ private:
     QPen _thickPen;
     bool _settingsOK;
     int tracerPlot_;
+    DesignHistory history_;                                 // accepted designs for undo/redo
+    DesignComparison comparison_;                           // designs overlaid on the cycle diagram
+    QDockWidget *comparisonDock_;
+    QListWidget *comparisonList_;
+    HeatmapView *heatmap_;                                  // design space tab, null until the tab is first opened
+    QWidget *heatmapTab_;
+    BilgramDialog *bilgram_;                                // null until first opened
+    DesignIndex knownDesigns_;                              // stored designs shown as neighbours of the current design
+    QLabel *knownDesignLabel_;
+    PerfHud *cycleHud_;                                     // performance overlays, owned by the plots
+    PerfHud *valveHud_;
+    QVector<QCPCurve*> valveMovingCurves_;                  // valve diagram shapes on the "valveMoving" layer, in ValveDiagram::movingShapes() order
+    QVector<QCPGraph*> cycleGraphs_;                        // cycle diagram region graphs, in CycleDiagram::segments() order
+    SVE::SampleResolution<double> cycleResolution_;         // resolution the cycle diagram curves were last sampled for
+    SVE::SampleResolution<double> cycleResolution(QCPRange xView, QCPRange yView);
 
     const std::map<CycleEnum, QString> cycleNames_{
                                                    {CycleEnum::compression, "Compression"},
@@ -49,16 +100,15 @@ private:
                                                   };
     void updateAnimationSlider(double deg);
     void updateCurrentAngle(double deg);
+    void updateValveDiagram();
     void updateCriticalPoint(double deg);
     void setCurrentCrank(double deg);
-    QCPDataContainer<QCPCurveData> drawSlide(double offset, double sizeParam);
-    QCPDataContainer<QCPCurveData> drawCylinder1(double outsideEdge, double insideEdge, double bottomEdge, double topEdge, double portWall, double piston);                     // generates curve data for the outer part of the cylinder
-    QCPDataContainer<QCPCurveData> drawCylinder2(double portWall, double insideEdge);                     // generates curve data for the inner part of the cylinder
-    QCPDataContainer<QCPCurveData> drawForwardShade(double stroke, double insideEdge, double portWall, double cylinderBottom, double pistonWidth);     // draws a curve for shading the forward cylinder space given stroke (stroke is 0 at TDC)
-    QCPDataContainer<QCPCurveData> drawReverseShade(double stroke, double insideEdge, double portWall, double cylinderBottom, double pistonWidth);     // draws a curve for shading the return cylinder space given stroke (stroke is 0 at TDC)
-    QCPDataContainer<QCPCurveData> drawPiston(double stroke, double portWall, double cylinderBottom, double pistonWidth);
-    QCPDataContainer<QCPCurveData> drawValveShade(double offset, double sizeParam);          // draws curve for shading the interior of the valve given valve position (position is 0 at valve neutral)
-    QCPDataContainer<QCPCurveData> drawSteamChestShade(double insideEdge, double steamChestTop);               // draws a curve for shading the interior of the steam chest
-    QCPDataContainer<QCPCurveData> drawExahustShade(double portWall);
+    void applyDesign(const s_designDims &dims, bool record);
+    s_designDims designDims() const;
+    void setDesignDims(const s_designDims &dims);
+    void updateUndoActions();
+    void drawComparison();
+    void setKnownDesigns(const QVector<DesignFile::Design> &designs);
+    void updateKnownDesigns(const s_designDims &dims);
 };
 #endif // MAINWINDOW_H
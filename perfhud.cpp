@@ -0,0 +1,95 @@
+#include "perfhud.h"
+
+PerfHud::PerfHud(QCustomPlot *plot) :
+    QCPLayerable(plot, QLatin1String("overlay"))
+{
+    _lastReplotTime = 0;
+    _font = QFont(QLatin1String("Monospace"), 8);
+    _font.setStyleHint(QFont::TypeWriter);
+    _clock.start();
+    setVisible(false);
+
+    connect(plot, SIGNAL(beforeReplot()), this, SLOT(replotStarted()));
+    connect(plot, SIGNAL(afterReplot()), this, SLOT(replotFinished()));
+}
+
+double PerfHud::lastReplotTime() const
+{
+    return _lastReplotTime;
+}
+
+double PerfHud::framesPerSecond() const
+{
+    // frames still in the queue may be older than a second if there has not been a replot since
+    int frames = 0;
+    qint64 now = _clock.elapsed();
+    for (qint64 t : _frameTimes)
+        if (now - t <= 1000)
+            frames++;
+    return frames;
+}
+
+void PerfHud::applyDefaultAntialiasingHint(QCPPainter *painter) const
+{
+    applyAntialiasingHint(painter, mAntialiased, QCP::aeOther);
+}
+
+/*!
+ * draws the statistics box. The replot time shown is from the previous replot, since this one is still in progress
+ */
+void PerfHud::draw(QCPPainter *painter)
+{
+    // count the data points of the plottables (graphs and curves are one dimensional, color maps are a grid)
+    int points = 0;
+    int mostPoints = 0;
+    for (int i=0; i<mParentPlot->plottableCount(); i++){
+        QCPAbstractPlottable *plottable = mParentPlot->plottable(i);
+        int n = 0;
+        if (QCPPlottableInterface1D *data = plottable->interface1D())
+            n = data->dataCount();
+        else if (QCPColorMap *map = qobject_cast<QCPColorMap*>(plottable))
+            n = map->data()->keySize() * map->data()->valueSize();
+        points += n;
+        if (n > mostPoints)
+            mostPoints = n;
+    }
+
+    QStringList lines;
+    lines << QString("replot  %1 ms").arg(_lastReplotTime, 0, 'f', 2)
+          << QString("fps     %1").arg(framesPerSecond(), 0, 'f', 0)
+          << QString("plots   %1").arg(mParentPlot->plottableCount())
+          << QString("points  %1 (max %2)").arg(points).arg(mostPoints);
+    QString text = lines.join(QLatin1Char('\n'));
+
+    painter->setFont(_font);
+    QRect textRect = painter->fontMetrics().boundingRect(QRect(0, 0, 1000, 1000), Qt::AlignLeft | Qt::AlignTop, text);
+    QRect box = textRect.adjusted(-4, -3, 4, 3).translated(mParentPlot->viewport().topLeft() + QPoint(8, 6));
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(QColor(0, 0, 0, 160));
+    painter->drawRect(box);
+    painter->setPen(Qt::white);
+    painter->drawText(box.adjusted(4, 3, -4, -3), Qt::AlignLeft | Qt::AlignTop, text);
+}
+
+void PerfHud::replotStarted()
+{
+    _replotTimer.start();
+}
+
+void PerfHud::replotFinished()
+{
+    recordReplot(_replotTimer.nsecsElapsed() / 1e6);
+}
+
+/*!
+ * records a replot that took <ms> milliseconds and ended now
+ */
+void PerfHud::recordReplot(double ms)
+{
+    _lastReplotTime = ms;
+
+    qint64 now = _clock.elapsed();
+    _frameTimes.enqueue(now);
+    while (!_frameTimes.isEmpty() && now - _frameTimes.head() > 1000)
+        _frameTimes.dequeue();
+}
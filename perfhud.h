@@ -0,0 +1,45 @@
+#ifndef PERFHUD_H
+#define PERFHUD_H
+
+#include <QElapsedTimer>
+#include <QQueue>
+#include "qcustomplot.h"
+
+/*!
+ * Overlay in the top left corner of a plot showing the time of the last replot, the number of plottables and the points
+ * they hold, and replots per second (while scrubbing the animation or dragging). Drawn on the "overlay" layer, so clearing
+ * the plottables or items of the plot does not remove it.
+ * Full replots are timed from the plot's replot signals. A plot that only replots a buffered layer (the valve diagram while
+ * scrubbing) reports the time with recordReplot() and replots the "overlay" layer to refresh the numbers.
+ * Usage:
+ *     PerfHud *hud = new PerfHud(ui->cyclePlot);      // owned by the plot
+ *     hud->setVisible(true);
+ */
+class PerfHud : public QCPLayerable
+{
+    Q_OBJECT
+
+public:
+    explicit PerfHud(QCustomPlot *plot);
+
+    double lastReplotTime() const;                  // milliseconds, 0 before the first replot
+    double framesPerSecond() const;                 // replots during the last second
+    void recordReplot(double ms);                   // counts a replot done without the plot's replot signals (a layer replot)
+
+protected:
+    virtual void applyDefaultAntialiasingHint(QCPPainter *painter) const override;
+    virtual void draw(QCPPainter *painter) override;
+
+private slots:
+    void replotStarted();
+    void replotFinished();
+
+private:
+    QElapsedTimer _replotTimer;                     // times the replot in progress
+    QElapsedTimer _clock;                           // time stamps for the frame rate
+    QQueue<qint64> _frameTimes;                     // end of each replot in the last second (ms)
+    double _lastReplotTime;
+    QFont _font;
+};
+
+#endif // PERFHUD_H
@@ -0,0 +1,313 @@
+#include "portflow.h"
+#include <limits>
+
+namespace {
+    const int flowTableSize = 1024;
+    // above this pressure ratio the flow is taken as linear in the pressure difference. The orifice equation goes like
+    // sqrt(dp) near equal pressures, which has an unbounded slope and would make the pressures chatter around equilibrium
+    const double linearRatio = 0.99;
+}
+
+SVE::PortFlowModel::PortFlowModel()
+{
+    _settings = defaultSettings();
+    _sweptVolume = 0;
+    _areaScale = 0;
+    _criticalRatio = 0;
+    _linearSlope = 0;
+}
+
+/*!
+ * settings for the default engine (psi, inches, in/s) on saturated steam, ports about 0.8 of the bore long
+ */
+SVE::PortFlowModel::Settings SVE::PortFlowModel::defaultSettings()
+{
+    Settings settings;
+    settings.supplyPressure = 114.7;
+    settings.exahustPressure = 14.7;
+    settings.gamma = 1.13;
+    settings.supplyVelocity = 18000.0;
+    settings.dischargeCoefficient = 0.7;
+    settings.portLength = 5.5;
+    settings.steps = 720;
+    settings.maxRevolutions = 20;
+    settings.tolerance = 1e-4;
+    return settings;
+}
+
+/*!
+ * sets the engine geometry and tabulates the port openings, volumes and cycle regions of both ends over one revolution
+ * \param params    engine geometry
+ * \param settings  steam properties, port length and table size
+ * \return error if the geometry is invalid
+ */
+ErrorEnum SVE::PortFlowModel::setDesign(const s_engineParamsT<double> &params, const Settings &settings)
+{
+    ErrorEnum ret = _engine.setEngineParams(params);
+    if (ret != ErrorEnum::none)
+        return ret;
+    _settings = settings;
+    _areaScale = settings.dischargeCoefficient * settings.portLength;
+
+    // psi^2 is smooth in the pressure ratio, so it interpolates well where psi itself does not
+    double g = settings.gamma;
+    _criticalRatio = std::pow(2 / (g + 1), g / (g - 1));
+    _flowTable.resize(flowTableSize + 1);
+    for (int i=0; i<=flowTableSize; i++){
+        double r = _criticalRatio + (1 - _criticalRatio) * i / flowTableSize;
+        _flowTable[i] = std::max(0.0, 2 * g / (g - 1) * (std::pow(r, 2 / g) - std::pow(r, (g + 1) / g)));
+    }
+    _linearSlope = std::sqrt(2 * g / (g - 1) * (std::pow(linearRatio, 2 / g) - std::pow(linearRatio, (g + 1) / g))) / (1 - linearRatio);
+
+    double area = SVE::pi<double>() * params.bore * params.bore / 4;
+    _sweptVolume = area * params.stroke;
+    const std::array<double, 8> points = _engine.criticalPoints();
+
+    int n = settings.steps + 1;
+    _degrees.resize(n);
+    for (int e=0; e<2; e++){
+        End &end = _ends[e];
+        end.admission.resize(n);
+        end.exahust.resize(n);
+        end.volume.resize(n);
+        end.dVolume.resize(n);
+        end.region.resize(n);
+        end.pressure.assign(n, settings.exahustPressure);
+        end.cutoff = points[e * 4 + 1];
+    }
+
+    for (int i=0; i<n; i++){
+        double deg = 360.0 * i / settings.steps;
+        _degrees[i] = deg;
+        double valvePos = _engine.crank2ValvePos(deg);
+        double dx = SVE::rad2Deg(SVE::crank2StrokeSlope(deg, params.stroke, params.conRod));
+
+        // the chest is outside the slide: above the top land's outside edge for the top port, below the bottom land's for the bottom
+        double topEdge = valvePos + params.valveSlide.topLand[1];
+        double botEdge = valvePos + params.valveSlide.botLand[1];
+        _ends[0].admission[i] = std::max(0.0, std::min(params.valvePorts.topPort[0], topEdge) - params.valvePorts.topPort[1]);
+        _ends[1].admission[i] = std::max(0.0, params.valvePorts.botPort[1] - std::max(params.valvePorts.botPort[0], botEdge));
+        _ends[0].exahust[i] = SVE::exahustFlow(params, valvePos, false).width;
+        _ends[1].exahust[i] = SVE::exahustFlow(params, valvePos, true).width;
+        _ends[0].volume[i] = _engine.cylinderVolume(deg, false);
+        _ends[1].volume[i] = _engine.cylinderVolume(deg, true);
+        _ends[0].dVolume[i] = area * dx;
+        _ends[1].dVolume[i] = -area * dx;
+        _ends[0].region[i] = _engine.crank2TopCycle(deg);
+        _ends[1].region[i] = _engine.crank2BotCycle(deg);
+    }
+    return ErrorEnum::none;
+}
+
+/*!
+ * orifice flow function psi(downstream / upstream pressure), choked below the critical ratio
+ */
+inline double SVE::PortFlowModel::flowFunction(double ratio) const
+{
+    if (ratio <= _criticalRatio)
+        return std::sqrt(_flowTable[0]);
+    if (ratio >= linearRatio)
+        return _linearSlope * (1 - std::min(ratio, 1.0));
+    double f = (ratio - _criticalRatio) / (1 - _criticalRatio) * flowTableSize;
+    int i = std::min(static_cast<int>(f), flowTableSize - 1);
+    double t = f - i;
+    return std::sqrt(_flowTable[i] + t * (_flowTable[i + 1] - _flowTable[i]));
+}
+
+/*!
+ * time derivatives of the pressure and the mass of one end
+ * \param admission effective admission area
+ * \param exahust   effective exahust area
+ * \param volume    cylinder volume
+ * \param dVolume   dV/dt
+ * \param p         cylinder pressure
+ * \param m         mass in the cylinder, as mass * R * T_supply (so m = p V at supply temperature)
+ * \param da        set to the net mass flow in through the admission port, in the same units as dm
+ */
+inline void SVE::PortFlowModel::derivatives(double admission, double exahust, double volume, double dVolume, double p, double m, double &dp, double &dm, double &da) const
+{
+    const double c = _settings.supplyVelocity;
+    const double g = _settings.gamma;
+    // temperature of the cylinder steam relative to the chest, the chest and exahust are both taken at the supply temperature
+    double temperature = p * volume / m;
+    double cylinderVelocity = c * std::sqrt(temperature);
+
+    double energy = 0;
+    dm = 0;
+    auto port = [&](double area, double reservoir) {
+        if (area <= 0)
+            return;
+        if (reservoir >= p){
+            double q = area * reservoir * flowFunction(p / reservoir) * c;      // mass flow * R T_supply
+            dm += q;
+            energy += g * q;
+        }else{
+            double q = area * p * flowFunction(reservoir / p) * c * c / cylinderVelocity;
+            dm -= q;
+            energy -= g * q * temperature;
+        }
+    };
+    port(admission, _settings.supplyPressure);
+    da = dm;
+    port(exahust, _settings.exahustPressure);
+    dp = (energy - g * p * dVolume) / volume;
+}
+
+/*!
+ * integrates one end over one table interval with 4th order Runge-Kutta sub steps, the geometry is interpolated within the interval
+ * \param end   end of the cylinder
+ * \param i     table interval, from angle i to i + 1
+ * \param dt    time the interval takes at the current speed
+ * \param w     speed, rad/s
+ * \param p     pressure, updated
+ * \param m     mass (see derivatives()), updated
+ * \param admitted  net mass admitted from the chest (see derivatives()), the interval's admission is added to it
+ */
+void SVE::PortFlowModel::advance(const End &end, int i, double dt, double w, double &p, double &m, double &admitted) const
+{
+    // sub steps short enough for the fastest filling or emptying rate in the interval (the linear flow region has the steepest slope)
+    double admission = std::max(end.admission[i], end.admission[i + 1]) * _areaScale;
+    double exahust = std::max(end.exahust[i], end.exahust[i + 1]) * _areaScale;
+    double volume = std::min(end.volume[i], end.volume[i + 1]);
+    double rate = 2 * _settings.gamma * _settings.supplyVelocity * _linearSlope * (admission + exahust) / volume;
+    int substeps = std::max(1, static_cast<int>(std::ceil(dt * rate)));
+    double h = dt / substeps;
+
+    auto at = [&](double f, double p, double m, double &dp, double &dm, double &da) {
+        derivatives((end.admission[i] + f * (end.admission[i + 1] - end.admission[i])) * _areaScale,
+                    (end.exahust[i] + f * (end.exahust[i + 1] - end.exahust[i])) * _areaScale,
+                    end.volume[i] + f * (end.volume[i + 1] - end.volume[i]),
+                    (end.dVolume[i] + f * (end.dVolume[i + 1] - end.dVolume[i])) * w,
+                    p, m, dp, dm, da);
+    };
+    for (int s=0; s<substeps; s++){
+        double f = static_cast<double>(s) / substeps;
+        double df = 1.0 / substeps;
+        double k1p, k1m, k1a, k2p, k2m, k2a, k3p, k3m, k3a, k4p, k4m, k4a;
+        at(f, p, m, k1p, k1m, k1a);
+        at(f + df/2, p + h/2 * k1p, m + h/2 * k1m, k2p, k2m, k2a);
+        at(f + df/2, p + h/2 * k2p, m + h/2 * k2m, k3p, k3m, k3a);
+        at(f + df, p + h * k3p, m + h * k3m, k4p, k4m, k4a);
+        p += h/6 * (k1p + 2*k2p + 2*k3p + k4p);
+        m += h/6 * (k1m + 2*k2m + 2*k3m + k4m);
+        admitted += h/6 * (k1a + 2*k2a + 2*k3a + k4a);
+        // keep the state physical if a step overshoots while the cylinder is almost empty
+        p = std::max(p, 1e-6 * _settings.exahustPressure);
+        m = std::max(m, 1e-9 * p * end.volume[i]);
+    }
+}
+
+/*!
+ * integrates the cylinder pressures of both ends at a constant speed until the cycle repeats
+ * \param rpm   crankshaft speed
+ * \return indicated work and the pressures at cutoff, during intake and during exahust (the pressures are kept, see pressure())
+ */
+SVE::PortFlowModel::Result SVE::PortFlowModel::run(double rpm)
+{
+    Result result{};
+    result.rpm = rpm;
+    int steps = _settings.steps;
+    if (_degrees.empty() || rpm <= 0)
+        return result;
+    double w = rpm * 2 * SVE::pi<double>() / 60;
+    double dt = 2 * SVE::pi<double>() / steps / w;
+
+    // start both ends at back pressure and supply temperature
+    double p[2];
+    double m[2];
+    for (int e=0; e<2; e++){
+        p[e] = _settings.exahustPressure;
+        m[e] = p[e] * _ends[e].volume[0];
+    }
+    std::vector<double> previous[2];
+    double admitted[2] = {0, 0};                    // over the last revolution
+    for (int revolution=0; revolution<_settings.maxRevolutions && !result.converged; revolution++){
+        double change = 0;
+        for (int e=0; e<2; e++){
+            End &end = _ends[e];
+            previous[e] = end.pressure;
+            end.pressure[0] = p[e];
+            admitted[e] = 0;
+            for (int i=0; i<steps; i++){
+                advance(end, i, dt, w, p[e], m[e], admitted[e]);
+                end.pressure[i + 1] = p[e];
+            }
+            for (int i=0; i<=steps; i++)
+                change = std::max(change, std::fabs(end.pressure[i] - previous[e][i]));
+        }
+        result.revolutions = revolution + 1;
+        result.converged = revolution > 0 && change < _settings.tolerance * _settings.supplyPressure;
+    }
+
+    const double step = 2 * SVE::pi<double>() / steps;
+    for (int e=0; e<2; e++){
+        const End &end = _ends[e];
+        double work = 0;
+        double admission = 0;
+        double exahust = 0;
+        int admissionCount = 0;
+        int exahustCount = 0;
+        for (int i=0; i<steps; i++){
+            work += (end.pressure[i] * end.dVolume[i] + end.pressure[i + 1] * end.dVolume[i + 1]) / 2 * step;
+            if (end.region[i] == CycleEnum::intake){
+                admission += end.pressure[i];
+                admissionCount++;
+            }else if (end.region[i] == CycleEnum::exahust){
+                exahust += end.pressure[i];
+                exahustCount++;
+            }
+        }
+        result.indicatedWork += work;
+        result.admittedVolume[e] = admitted[e] / _settings.supplyPressure;
+        result.admissionPressure[e] = admissionCount ? admission / admissionCount : std::numeric_limits<double>::quiet_NaN();
+        result.exahustPressure[e] = exahustCount ? exahust / exahustCount : std::numeric_limits<double>::quiet_NaN();
+
+        double f = end.cutoff / 360.0 * steps;
+        int i = std::min(static_cast<int>(f), steps - 1);
+        result.cutoffPressure[e] = end.pressure[i] + (f - i) * (end.pressure[i + 1] - end.pressure[i]);
+    }
+    result.meanEffectivePressure = result.indicatedWork / (2 * _sweptVolume);
+    return result;
+}
+
+/*!
+ * changes the steam chest pressure. The tables only depend on the geometry and the steam properties, so a grid of chest
+ * pressures (see SVE::speedCorrectedSteamMap) tabulates the design once
+ */
+void SVE::PortFlowModel::setSupplyPressure(double pressure)
+{
+    _settings.supplyPressure = pressure;
+}
+
+/*!
+ * runs every speed of an rpm sweep on the same geometry tables
+ * \return one result per speed, the pressures of the last speed are kept
+ */
+std::vector<SVE::PortFlowModel::Result> SVE::PortFlowModel::sweep(const std::vector<double> &rpm)
+{
+    std::vector<Result> results;
+    results.reserve(rpm.size());
+    for (double speed : rpm)
+        results.push_back(run(speed));
+    return results;
+}
+
+const std::vector<double> &SVE::PortFlowModel::degrees() const
+{
+    return _degrees;
+}
+
+const std::vector<double> &SVE::PortFlowModel::pressure(bool ret) const
+{
+    return _ends[ret ? 1 : 0].pressure;
+}
+
+double SVE::PortFlowModel::admissionWidth(int i, bool ret) const
+{
+    return _ends[ret ? 1 : 0].admission[i];
+}
+
+double SVE::PortFlowModel::exahustWidth(int i, bool ret) const
+{
+    return _ends[ret ? 1 : 0].exahust[i];
+}
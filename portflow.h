@@ -0,0 +1,93 @@
+#ifndef PORTFLOW_H
+#define PORTFLOW_H
+
+#include <vector>
+#include "slidevalveengine.h"
+
+namespace SVE {
+    /*!
+     * Speed dependent cylinder pressures (wiredrawing): steam flows through the instantaneous port openings as compressible
+     * flow through an orifice, so at speed the cylinder no longer reaches chest pressure before cutoff, and does not fall to
+     * back pressure during exahust.
+     *     mass flow = Cd * A * p_up * psi(p_down / p_up) / sqrt(R T_up)         (psi choked below the critical pressure ratio)
+     *     V dp/dt = gamma * (R T_in * inflow - R T_cyl * outflow) - gamma * p * dV/dt
+     * The port areas, volumes and dV/dtheta of both ends only depend on the geometry, so they are tabulated once per design by
+     * setDesign() and every speed of a sweep reuses them. Each speed integrates the pressures over crank angle until the cycle
+     * repeats. Any consistent units can be used (e.g. psi, inches, in/s); speeds are in rpm.
+     * Usage:
+     *     SVE::PortFlowModel model;
+     *     model.setDesign(engine.getEngineParams(), SVE::PortFlowModel::defaultSettings());
+     *     std::vector<SVE::PortFlowModel::Result> results = model.sweep({100, 200, 400, 800});
+     */
+    class PortFlowModel
+    {
+    public:
+        struct Settings
+        {
+            double supplyPressure;          // steam chest pressure (absolute)
+            double exahustPressure;         // back pressure (absolute)
+            double gamma;                   // isentropic exponent of the steam, about 1.3 superheated, 1.13 saturated
+            double supplyVelocity;          // sqrt(R T) of the chest steam, about 18000 in/s for 115 psi saturated steam
+            double dischargeCoefficient;    // effective area / port opening area
+            double portLength;              // length of the ports across the valve face (areas are opening widths * portLength)
+            int steps;                      // crank angle steps per revolution
+            int maxRevolutions;             // revolutions integrated looking for a repeating cycle
+            double tolerance;               // cycle repeats when the pressures change less than this fraction of supplyPressure
+        };
+
+        struct Result
+        {
+            double rpm;
+            int revolutions;                // revolutions integrated
+            bool converged;                 // the cycle repeated within tolerance
+            double indicatedWork;           // steam work per revolution, both ends
+            double meanEffectivePressure;   // indicatedWork / (2 * swept volume)
+            double cutoffPressure[2];       // cylinder pressure at cutoff, [0] top end, [1] bottom end
+            double admissionPressure[2];    // mean cylinder pressure during intake
+            double exahustPressure[2];      // mean cylinder pressure during exahust
+            double admittedVolume[2];       // net steam taken from the chest per revolution, as a volume at chest pressure and temperature
+        };
+
+        PortFlowModel();
+
+        ErrorEnum setDesign(const s_engineParamsT<double> &params, const Settings &settings);     // tabulates the port geometry
+        void setSupplyPressure(double pressure);                        // new chest pressure, keeps the geometry tables
+        Result run(double rpm);
+        std::vector<Result> sweep(const std::vector<double> &rpm);      // every speed reuses the geometry tables
+        const std::vector<double> &degrees() const;                     // crank angles of the tables
+        const std::vector<double> &pressure(bool ret) const;            // cylinder pressure of the last run, ret = bottom end
+        double admissionWidth(int i, bool ret) const;                   // steam port opening to the chest at table angle i
+        double exahustWidth(int i, bool ret) const;                     // exahust path width at table angle i
+
+        static Settings defaultSettings();
+
+    private:
+        // geometry of one end of the cylinder at each table angle
+        struct End
+        {
+            std::vector<double> admission;      // steam port opening to the chest
+            std::vector<double> exahust;        // exahust path width, see SVE::exahustFlow
+            std::vector<double> volume;
+            std::vector<double> dVolume;        // dV/dtheta per radian
+            std::vector<CycleEnum> region;
+            double cutoff;                      // crank angle
+            std::vector<double> pressure;       // result of the last run
+        };
+
+        SlideValveEngineT<double> _engine;
+        Settings _settings;
+        double _sweptVolume;
+        double _areaScale;                      // effective area per opening width, Cd * portLength
+        double _criticalRatio;                  // choked below this downstream / upstream pressure ratio
+        std::vector<double> _flowTable;         // psi^2 tabulated over the pressure ratio
+        double _linearSlope;                    // psi per (1 - ratio) in the linear region near equal pressures
+        std::vector<double> _degrees;
+        End _ends[2];
+
+        double flowFunction(double ratio) const;
+        void derivatives(double admission, double exahust, double volume, double dVolume, double p, double m, double &dp, double &dm, double &da) const;
+        void advance(const End &end, int i, double dt, double w, double &p, double &m, double &admitted) const;
+    };
+}
+
+#endif // PORTFLOW_H
@@ -0,0 +1,24 @@
+# builds the slidevalve Python module:  pip install ./python   (pyproject.toml brings pybind11, numpy is installed with it)
+import os
+from setuptools import setup
+from pybind11.setup_helpers import Pybind11Extension, build_ext
+
+root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+engineSources = ["slidevalveengine.cpp", "kinematictable.cpp", "designbatch.cpp", "dynamicsimulation.cpp", "portflow.cpp", "steammap.cpp"]
+
+setup(
+    name="slidevalve",
+    version="0.1",
+    description="slide valve steam engine kinematics",
+    ext_modules=[
+        Pybind11Extension(
+            "slidevalve",
+            ["slidevalve.cpp"] + [os.path.join(root, source) for source in engineSources],
+            include_dirs=[root],
+            cxx_std=17,
+        )
+    ],
+    cmdclass={"build_ext": build_ext},
+    install_requires=["numpy"],
+    zip_safe=False,
+)
@@ -0,0 +1,490 @@
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include "slidevalveengine.h"
+#include "designbatch.h"
+#include "dynamicsimulation.h"
+#include "enginesnapshot.h"
+#include "portflow.h"
+#include "steammap.h"
+
+/*
+ * Python bindings for the engine model (double precision).
+ * Array arguments are read in place when they are C contiguous float64 (other arrays are converted once),
+ * results are written into NumPy arrays directly, or into a caller supplied out= array, so nothing is copied on the way back.
+ * The GIL is released while the engine evaluates, so Python threads running sweeps run in parallel.
+ */
+
+namespace py = pybind11;
+
+namespace {
+    typedef py::array_t<double, py::array::c_style | py::array::forcecast> InArray;
+    typedef py::array_t<double, py::array::c_style> OutArray;
+
+    double s_designDims::*dimension(const std::string &name)
+    {
+        for (const s_designDimension &dim : SVE::designDimensions)
+            if (name == dim.name)
+                return dim.member;
+        throw py::value_error("unknown design dimension " + name);
+    }
+
+    /*!
+     * the array results are written to: <out> if given (must be a writable C contiguous float64 array of <shape>), otherwise a new array
+     */
+    OutArray outputArray(const std::vector<py::ssize_t> &shape, const py::object &out)
+    {
+        if (out.is_none())
+            return OutArray(shape);
+
+        if (!OutArray::check_(out))
+            throw py::type_error("out must be a C contiguous float64 array");
+        OutArray result = py::reinterpret_borrow<OutArray>(out);
+        if (std::vector<py::ssize_t>(result.shape(), result.shape() + result.ndim()) != shape)
+            throw py::value_error("out has the wrong shape");
+        if (!result.writeable())
+            throw py::value_error("out is read only");
+        return result;
+    }
+
+    /*!
+     * applies <f> to every element of <in>, without the GIL
+     */
+    template <typename F>
+    OutArray mapArray(const InArray &in, const py::object &out, F f)
+    {
+        OutArray result = outputArray(std::vector<py::ssize_t>(in.shape(), in.shape() + in.ndim()), out);
+        const double *src = in.data();
+        double *dst = result.mutable_data();
+        py::ssize_t n = in.size();
+        {
+            py::gil_scoped_release release;
+            for (py::ssize_t i=0; i<n; i++)
+                dst[i] = f(src[i]);
+        }
+        return result;
+    }
+
+    /*!
+     * immutable copy of a Python owned engine, taken while holding the GIL. Work done without the GIL uses the copy, so another
+     * Python thread can call set_engine_params on the original meanwhile
+     */
+    SVE::EngineSnapshot<double> snapshot(const SlideValveEngine &engine)
+    {
+        return std::make_shared<const SlideValveEngine>(engine);
+    }
+
+    /*!
+     * NumPy view of a vector's data. The vector is moved into a capsule owned by the array, so it is freed with the array, not copied
+     */
+    OutArray adopt(std::vector<double> &&data, const std::vector<py::ssize_t> &shape)
+    {
+        std::vector<double> *owner = new std::vector<double>(std::move(data));
+        py::capsule base(owner, [](void *p) { delete static_cast<std::vector<double> *>(p); });
+        return OutArray(shape, owner->data(), base);
+    }
+
+    std::vector<s_engineParams> paramsList(const std::vector<s_designDims> &designs)
+    {
+        std::vector<s_engineParams> params;
+        params.reserve(designs.size());
+        for (const s_designDims &dims : designs)
+            params.push_back(SVE::designParams(dims));
+        return params;
+    }
+
+    template <size_t N>
+    std::array<double, N> toArray(const double (&values)[N])
+    {
+        std::array<double, N> a;
+        std::copy(values, values + N, a.begin());
+        return a;
+    }
+
+    template <size_t N>
+    void fromArray(double (&values)[N], const std::array<double, N> &a)
+    {
+        std::copy(a.begin(), a.end(), values);
+    }
+}
+
+PYBIND11_MODULE(slidevalve, m)
+{
+    m.doc() = "slide valve steam engine kinematics";
+
+    py::enum_<ErrorEnum>(m, "Error")
+            .value("none", ErrorEnum::none)
+            .value("error", ErrorEnum::error);
+
+    py::enum_<CycleEnum>(m, "Cycle")
+            .value("intake", CycleEnum::intake)
+            .value("expansion", CycleEnum::expansion)
+            .value("exahust", CycleEnum::exahust)
+            .value("compression", CycleEnum::compression);
+
+    py::enum_<MetricEnum>(m, "Metric")
+            .value("cutoff", MetricEnum::cutoff)
+            .value("lead", MetricEnum::lead)
+            .value("exahust_lead", MetricEnum::exahustLead)
+            .value("compression", MetricEnum::compression)
+            .value("exahust_restriction", MetricEnum::exahustRestriction)
+            .value("cushion", MetricEnum::cushion);
+
+    // the port and land edge pairs are exposed as 2-tuples
+    py::class_<s_engineParams>(m, "EngineParams")
+            .def(py::init([]() { return SVE::defaultEngineParams<double>(); }))
+            .def_readwrite("bore", &s_engineParams::bore)
+            .def_readwrite("stroke", &s_engineParams::stroke)
+            .def_readwrite("con_rod", &s_engineParams::conRod)
+            .def_readwrite("valve_travel", &s_engineParams::valveTravel)
+            .def_readwrite("valve_con_rod", &s_engineParams::valveConRod)
+            .def_readwrite("eccentric_advance", &s_engineParams::eccentricAdvance)
+            .def_property("top_port",
+                          [](const s_engineParams &p) { return toArray(p.valvePorts.topPort); },
+                          [](s_engineParams &p, const std::array<double, 2> &a) { fromArray(p.valvePorts.topPort, a); })
+            .def_property("bot_port",
+                          [](const s_engineParams &p) { return toArray(p.valvePorts.botPort); },
+                          [](s_engineParams &p, const std::array<double, 2> &a) { fromArray(p.valvePorts.botPort, a); })
+            .def_property("ex_port",
+                          [](const s_engineParams &p) { return toArray(p.valvePorts.exPort); },
+                          [](s_engineParams &p, const std::array<double, 2> &a) { fromArray(p.valvePorts.exPort, a); })
+            .def_property("top_land",
+                          [](const s_engineParams &p) { return toArray(p.valveSlide.topLand); },
+                          [](s_engineParams &p, const std::array<double, 2> &a) { fromArray(p.valveSlide.topLand, a); })
+            .def_property("bot_land",
+                          [](const s_engineParams &p) { return toArray(p.valveSlide.botLand); },
+                          [](s_engineParams &p, const std::array<double, 2> &a) { fromArray(p.valveSlide.botLand, a); })
+            .def_property("clearance",
+                          [](const s_engineParams &p) { return toArray(p.clearance); },
+                          [](s_engineParams &p, const std::array<double, 2> &a) { fromArray(p.clearance, a); });
+
+    py::class_<s_designDims> designDims(m, "DesignDims");
+    designDims.def(py::init([]() { return SVE::designDims(SVE::defaultEngineParams<double>()); }));
+    for (const s_designDimension &dim : SVE::designDimensions){
+        double s_designDims::*member = dim.member;
+        designDims.def_property(dim.name,
+                                [member](const s_designDims &d) { return d.*member; },
+                                [member](s_designDims &d, double value) { d.*member = value; });
+    }
+    m.attr("dimensions") = [] {
+        py::list names;
+        for (const s_designDimension &dim : SVE::designDimensions)
+            names.append(dim.name);
+        return names;
+    }();
+
+    py::class_<s_exahustFlow>(m, "ExahustFlow")
+            .def_readonly("port_opening", &s_exahustFlow::portOpening)
+            .def_readonly("exahust_opening", &s_exahustFlow::exahustOpening)
+            .def_readonly("width", &s_exahustFlow::width);
+
+    py::class_<s_exahustBottleneck>(m, "ExahustBottleneck")
+            .def_readonly("exahust_opening", &s_exahustBottleneck::exahustOpening)
+            .def_readonly("crank", &s_exahustBottleneck::crank)
+            .def_readonly("port_opening", &s_exahustBottleneck::portOpening)
+            .def_readonly("ratio", &s_exahustBottleneck::ratio);
+
+    py::class_<s_valveLoadSettings>(m, "ValveLoadSettings")
+            .def(py::init([]() { return s_valveLoadSettings{100.0, 14.7, 1.0, 0.1, 0.01, 20.0}; }))
+            .def_readwrite("chest_pressure", &s_valveLoadSettings::chestPressure)
+            .def_readwrite("exahust_pressure", &s_valveLoadSettings::exahustPressure)
+            .def_readwrite("port_length", &s_valveLoadSettings::portLength)
+            .def_readwrite("friction", &s_valveLoadSettings::friction)
+            .def_readwrite("valve_mass", &s_valveLoadSettings::valveMass)
+            .def_readwrite("speed", &s_valveLoadSettings::speed);
+
+    py::class_<s_valveLoad>(m, "ValveLoad")
+            .def_readonly("normal_force", &s_valveLoad::normalForce)
+            .def_readonly("friction", &s_valveLoad::friction)
+            .def_readonly("inertia", &s_valveLoad::inertia)
+            .def_readonly("rod_force", &s_valveLoad::rodForce)
+            .def_readonly("strap_force", &s_valveLoad::strapForce)
+            .def_readonly("eccentric_torque", &s_valveLoad::eccentricTorque);
+
+    // free kinematics
+    m.def("design_params", &SVE::designParams<double>, py::arg("dims"));
+    m.def("design_dims", &SVE::designDims<double>, py::arg("params"));
+    m.def("check_geometry", &SVE::checkGeometry<double>, py::arg("params"));
+    m.def("add_angles", [](double deg1, double deg2) { return SVE::addAngles(deg1, deg2); }, py::arg("deg1"), py::arg("deg2"));
+    m.def("crank2stroke",
+          [](const InArray &deg, double stroke, double length, const py::object &out) {
+              return mapArray(deg, out, [stroke, length](double d) { return SVE::crank2Stroke(d, stroke, length); });
+          }, py::arg("deg"), py::arg("stroke"), py::arg("length"), py::arg("out") = py::none());
+    m.def("stroke2crank",
+          [](const InArray &pos, double stroke, double length, bool ret, const py::object &out) {
+              return mapArray(pos, out, [stroke, length, ret](double p) { return SVE::stroke2Crank(p, stroke, length, ret); });
+          }, py::arg("pos"), py::arg("stroke"), py::arg("length"), py::arg("ret") = false, py::arg("out") = py::none());
+    m.def("exahust_flow", &SVE::exahustFlow<double>, py::arg("params"), py::arg("valve_pos"), py::arg("ret") = false);
+    m.def("exahust_bottleneck", &SVE::exahustBottleneck<double>, py::arg("params"), py::arg("ret") = false);
+
+    // the engine. Array methods take crank angles (or positions) of any shape and return the same shape
+    py::class_<SlideValveEngine>(m, "SlideValveEngine")
+            .def(py::init<>())
+            .def(py::init<s_engineParams>(), py::arg("params"))
+            .def(py::init([](const s_designDims &dims) { return SlideValveEngine(SVE::designParams(dims)); }), py::arg("dims"))
+            .def("set_engine_params", &SlideValveEngine::setEngineParams, py::arg("params"))
+            .def("get_engine_params", &SlideValveEngine::getEngineParams)
+            .def("prepare_tables", &SlideValveEngine::prepareTables)
+            .def("critical_points", &SlideValveEngine::criticalPoints)
+            .def("top_critical_points", &SlideValveEngine::topCriticalPoints)
+            .def("bot_critical_points", &SlideValveEngine::botCriticalPoints)
+            .def("crank2stroke",
+                 [](const SlideValveEngine &e, const InArray &deg, const py::object &out) {
+                     SVE::EngineSnapshot<double> engine = snapshot(e);
+                     return mapArray(deg, out, [engine](double d) { return engine->crank2Stroke(d); });
+                 }, py::arg("deg"), py::arg("out") = py::none())
+            .def("crank2valve_pos",
+                 [](const SlideValveEngine &e, const InArray &deg, const py::object &out) {
+                     SVE::EngineSnapshot<double> engine = snapshot(e);
+                     return mapArray(deg, out, [engine](double d) { return engine->crank2ValvePos(d); });
+                 }, py::arg("deg"), py::arg("out") = py::none())
+            .def("stroke2crank",
+                 [](const SlideValveEngine &e, const InArray &pos, bool ret, const py::object &out) {
+                     SVE::EngineSnapshot<double> engine = snapshot(e);
+                     return mapArray(pos, out, [engine, ret](double p) { return engine->stroke2Crank(p, ret); });
+                 }, py::arg("pos"), py::arg("ret") = false, py::arg("out") = py::none())
+            .def("valve_pos2crank",
+                 [](const SlideValveEngine &e, const InArray &pos, bool ret, const py::object &out) {
+                     SVE::EngineSnapshot<double> engine = snapshot(e);
+                     return mapArray(pos, out, [engine, ret](double p) { return engine->valvePos2Crank(p, ret); });
+                 }, py::arg("pos"), py::arg("ret") = false, py::arg("out") = py::none())
+            .def("crank2top_cycle", &SlideValveEngine::crank2TopCycle, py::arg("deg"))
+            .def("crank2bot_cycle", &SlideValveEngine::crank2BotCycle, py::arg("deg"))
+            .def("metric", &SlideValveEngine::metric, py::arg("metric"), py::arg("ret") = false)
+            .def("exahust_flow", &SlideValveEngine::exahustFlow, py::arg("deg"), py::arg("ret") = false)
+            .def("exahust_bottleneck", &SlideValveEngine::exahustBottleneck, py::arg("ret") = false)
+            .def("valve_load", &SlideValveEngine::valveLoad, py::arg("deg"), py::arg("settings"));
+
+    // batch APIs
+    m.def("evaluate_batch",
+          [](const std::vector<s_designDims> &designs, double start, double stop, int steps) {
+              SVE::DesignBatch<double> batch;
+              std::vector<double> degrees;
+              {
+                  py::gil_scoped_release release;
+                  SVE::AngleGrid<double> grid(start, stop, steps);
+                  batch = SVE::evaluateBatch(grid, paramsList(designs));
+                  degrees = grid.degrees();
+              }
+              std::vector<py::ssize_t> shape = {static_cast<py::ssize_t>(designs.size()), batch.gridSize};
+              py::dict result;
+              result["crank"] = adopt(std::move(degrees), {batch.gridSize});
+              result["stroke"] = adopt(std::move(batch.stroke), shape);
+              result["valve_pos"] = adopt(std::move(batch.valvePos), shape);
+              result["top_exahust"] = adopt(std::move(batch.topExahust), shape);
+              result["bot_exahust"] = adopt(std::move(batch.botExahust), shape);
+              return result;
+          }, py::arg("designs"), py::arg("start") = 0.0, py::arg("stop") = 360.0, py::arg("steps") = 360,
+          "piston and valve positions and exahust flow widths of many designs, as (designs, steps + 1) arrays");
+
+    m.def("valve_loads",
+          [](const std::vector<s_designDims> &designs, const s_valveLoadSettings &settings, double start, double stop, int steps) {
+              SVE::ValveLoadBatch<double> batch;
+              std::vector<double> degrees;
+              {
+                  py::gil_scoped_release release;
+                  SVE::AngleGrid<double> grid(start, stop, steps);
+                  batch = SVE::valveLoads(grid, paramsList(designs), settings);
+                  degrees = grid.degrees();
+              }
+              std::vector<py::ssize_t> shape = {static_cast<py::ssize_t>(designs.size()), batch.gridSize};
+              std::vector<py::ssize_t> perDesign = {static_cast<py::ssize_t>(designs.size())};
+              py::dict result;
+              result["crank"] = adopt(std::move(degrees), {batch.gridSize});
+              result["rod_force"] = adopt(std::move(batch.rodForce), shape);
+              result["strap_force"] = adopt(std::move(batch.strapForce), shape);
+              result["eccentric_torque"] = adopt(std::move(batch.eccentricTorque), shape);
+              result["peak_rod_force"] = adopt(std::move(batch.peakRodForce), perDesign);
+              result["peak_strap_force"] = adopt(std::move(batch.peakStrapForce), perDesign);
+              result["rms_strap_force"] = adopt(std::move(batch.rmsStrapForce), perDesign);
+              return result;
+          }, py::arg("designs"), py::arg("settings"), py::arg("start") = 0.0, py::arg("stop") = 360.0, py::arg("steps") = 360,
+          "valve rod, eccentric strap and eccentric torque loads of many designs as (designs, steps + 1) arrays, with per design peaks");
+
+    // dynamic simulation, settings are read and written by field name
+    typedef SVE::DynamicSimulation::Settings SimulationSettings;
+    py::class_<SimulationSettings>(m, "SimulationSettings")
+            .def(py::init(&SVE::DynamicSimulation::defaultSettings))
+            .def_readwrite("supply_pressure", &SimulationSettings::supplyPressure)
+            .def_readwrite("exahust_pressure", &SimulationSettings::exahustPressure)
+            .def_readwrite("polytropic_exponent", &SimulationSettings::polytropicExponent)
+            .def_readwrite("inertia", &SimulationSettings::inertia)
+            .def_readwrite("load_torque", &SimulationSettings::loadTorque)
+            .def_readwrite("viscous_load", &SimulationSettings::viscousLoad)
+            .def_readwrite("fan_load", &SimulationSettings::fanLoad)
+            .def_readwrite("initial_speed", &SimulationSettings::initialSpeed)
+            .def_readwrite("initial_crank", &SimulationSettings::initialCrank)
+            .def_readwrite("time_step", &SimulationSettings::timeStep)
+            .def_readwrite("angle_step", &SimulationSettings::angleStep)
+            .def_readwrite("revolutions", &SimulationSettings::revolutions)
+            .def_readwrite("max_time", &SimulationSettings::maxTime)
+            .def_readwrite("measure_revolutions", &SimulationSettings::measureRevolutions);
+
+    m.def("simulate_designs",
+          [](const std::vector<s_designDims> &designs, const SimulationSettings &settings) {
+              std::vector<SVE::DynamicSimulation::Result> results;
+              {
+                  py::gil_scoped_release release;
+                  results = SVE::simulateDesigns(paramsList(designs), settings);
+              }
+              size_t n = results.size();
+              std::vector<double> meanSpeed(n), fluctuation(n), startTime(n), indicatedWork(n), stalled(n);
+              for (size_t d=0; d<n; d++){
+                  meanSpeed[d] = results[d].meanSpeed;
+                  fluctuation[d] = results[d].fluctuation;
+                  startTime[d] = results[d].startTime;
+                  indicatedWork[d] = results[d].indicatedWork;
+                  stalled[d] = results[d].stalled ? 1 : 0;
+              }
+              std::vector<py::ssize_t> shape = {static_cast<py::ssize_t>(n)};
+              py::dict result;
+              result["mean_speed"] = adopt(std::move(meanSpeed), shape);
+              result["fluctuation"] = adopt(std::move(fluctuation), shape);
+              result["start_time"] = adopt(std::move(startTime), shape);
+              result["indicated_work"] = adopt(std::move(indicatedWork), shape);
+              result["stalled"] = adopt(std::move(stalled), shape);
+              return result;
+          }, py::arg("designs"), py::arg("settings"),
+          "flywheel speed simulation of each design: mean speed (rad/s), speed fluctuation, start time (s), work per revolution, stalled (1/0)");
+
+    // port flow (wiredrawing) model
+    typedef SVE::PortFlowModel::Settings PortFlowSettings;
+    py::class_<PortFlowSettings>(m, "PortFlowSettings")
+            .def(py::init(&SVE::PortFlowModel::defaultSettings))
+            .def_readwrite("supply_pressure", &PortFlowSettings::supplyPressure)
+            .def_readwrite("exahust_pressure", &PortFlowSettings::exahustPressure)
+            .def_readwrite("gamma", &PortFlowSettings::gamma)
+            .def_readwrite("supply_velocity", &PortFlowSettings::supplyVelocity)
+            .def_readwrite("discharge_coefficient", &PortFlowSettings::dischargeCoefficient)
+            .def_readwrite("port_length", &PortFlowSettings::portLength)
+            .def_readwrite("steps", &PortFlowSettings::steps)
+            .def_readwrite("max_revolutions", &PortFlowSettings::maxRevolutions)
+            .def_readwrite("tolerance", &PortFlowSettings::tolerance);
+
+    m.def("rpm_sweep",
+          [](const s_designDims &dims, const InArray &rpm, const PortFlowSettings &settings) {
+              std::vector<double> speeds(rpm.data(), rpm.data() + rpm.size());
+              std::vector<SVE::PortFlowModel::Result> results;
+              {
+                  py::gil_scoped_release release;
+                  SVE::PortFlowModel model;
+                  if (model.setDesign(SVE::designParams(dims), settings) == ErrorEnum::none)
+                      results = model.sweep(speeds);
+              }
+              if (results.size() != speeds.size())
+                  throw py::value_error("invalid design geometry");
+              size_t n = results.size();
+              std::vector<double> mep(n), work(n), converged(n), cutoff(n * 2), admission(n * 2), exahust(n * 2), admitted(n * 2);
+              for (size_t i=0; i<n; i++){
+                  mep[i] = results[i].meanEffectivePressure;
+                  work[i] = results[i].indicatedWork;
+                  converged[i] = results[i].converged ? 1 : 0;
+                  for (int e=0; e<2; e++){
+                      cutoff[i * 2 + e] = results[i].cutoffPressure[e];
+                      admission[i * 2 + e] = results[i].admissionPressure[e];
+                      exahust[i * 2 + e] = results[i].exahustPressure[e];
+                      admitted[i * 2 + e] = results[i].admittedVolume[e];
+                  }
+              }
+              std::vector<py::ssize_t> shape = {static_cast<py::ssize_t>(n)};
+              std::vector<py::ssize_t> ends = {static_cast<py::ssize_t>(n), 2};
+              py::dict result;
+              result["mean_effective_pressure"] = adopt(std::move(mep), shape);
+              result["indicated_work"] = adopt(std::move(work), shape);
+              result["converged"] = adopt(std::move(converged), shape);
+              result["cutoff_pressure"] = adopt(std::move(cutoff), ends);
+              result["admission_pressure"] = adopt(std::move(admission), ends);
+              result["exahust_pressure"] = adopt(std::move(exahust), ends);
+              result["admitted_volume"] = adopt(std::move(admitted), ends);
+              return result;
+          }, py::arg("dims"), py::arg("rpm"), py::arg("settings"),
+          "speed dependent cylinder pressures of one design over an rpm sweep, per end arrays are (speeds, 2) with the top end first");
+
+    // steam consumption maps
+    py::class_<SVE::SteamMapSettings>(m, "SteamMapSettings")
+            .def(py::init(&SVE::defaultSteamMapSettings))
+            .def_readwrite("exahust_pressure", &SVE::SteamMapSettings::exahustPressure)
+            .def_readwrite("polytropic_exponent", &SVE::SteamMapSettings::polytropicExponent)
+            .def_readwrite("density_coefficient", &SVE::SteamMapSettings::densityCoefficient)
+            .def_readwrite("density_exponent", &SVE::SteamMapSettings::densityExponent)
+            .def_readwrite("power_unit", &SVE::SteamMapSettings::powerUnit)
+            .def_readwrite("flow", &SVE::SteamMapSettings::flow);
+
+    m.def("steam_map",
+          [](const s_designDims &dims, const InArray &rpm, const InArray &pressures, const SVE::SteamMapSettings &settings,
+             bool speedCorrected) {
+              std::vector<double> speeds(rpm.data(), rpm.data() + rpm.size());
+              std::vector<double> chest(pressures.data(), pressures.data() + pressures.size());
+              SVE::SteamMap map;
+              {
+                  py::gil_scoped_release release;
+                  if (speedCorrected)
+                      map = SVE::speedCorrectedSteamMap(SVE::designParams(dims), speeds, chest, settings);
+                  else
+                      map = SVE::steamMap(SVE::designParams(dims), speeds, chest, settings);
+              }
+              std::vector<py::ssize_t> shape = {map.rpmCount, map.pressureCount};
+              py::dict result;
+              result["steam_per_revolution"] = adopt(std::move(map.steamPerRevolution), shape);
+              result["indicated_work"] = adopt(std::move(map.indicatedWork), shape);
+              result["indicated_power"] = adopt(std::move(map.indicatedPower), shape);
+              result["steam_rate"] = adopt(std::move(map.steamRate), shape);
+              result["water_rate"] = adopt(std::move(map.waterRate), shape);
+              return result;
+          }, py::arg("dims"), py::arg("rpm"), py::arg("pressures"), py::arg("settings") = SVE::defaultSteamMapSettings(),
+          py::arg("speed_corrected") = false,
+          "steam consumption and indicated power over a speed x chest pressure grid, (rpm, pressures) arrays, NaN for an invalid design. "
+          "The ideal cycle by default (fast, the same per revolution at every speed), speed_corrected runs the port flow model "
+          "at every point (NaN where it did not converge)");
+
+    m.def("exahust_bottleneck_ratios",
+          [](const std::vector<s_designDims> &designs) {
+              std::vector<double> ratios(designs.size() * 2);
+              {
+                  py::gil_scoped_release release;
+                  std::vector<SVE::ExahustBottlenecks<double>> bottlenecks = SVE::exahustBottlenecks(paramsList(designs));
+                  for (size_t d=0; d<bottlenecks.size(); d++){
+                      ratios[d * 2] = bottlenecks[d][0].ratio;
+                      ratios[d * 2 + 1] = bottlenecks[d][1].ratio;
+                  }
+              }
+              return adopt(std::move(ratios), {static_cast<py::ssize_t>(designs.size()), 2});
+          }, py::arg("designs"), "exahust bottleneck ratios, (designs, 2) array of [top, bottom]");
+
+    m.def("cushion_pressures",
+          [](const std::vector<s_designDims> &designs, double exahustPressure, double exponent) {
+              std::vector<double> pressures(designs.size() * 2);
+              {
+                  py::gil_scoped_release release;
+                  std::vector<std::array<double, 2>> cushions = SVE::cushionPressures(paramsList(designs), exahustPressure, exponent);
+                  for (size_t d=0; d<cushions.size(); d++){
+                      pressures[d * 2] = cushions[d][0];
+                      pressures[d * 2 + 1] = cushions[d][1];
+                  }
+              }
+              return adopt(std::move(pressures), {static_cast<py::ssize_t>(designs.size()), 2});
+          }, py::arg("designs"), py::arg("exahust_pressure") = 14.7, py::arg("exponent") = 1.13,
+          "pressure at the end of compression, (designs, 2) array of [top, bottom], NaN for invalid designs");
+
+    m.def("metric_grid",
+          [](const s_designDims &base, const std::string &xName, const InArray &xValues, const std::string &yName, const InArray &yValues,
+             MetricEnum metric, bool ret, const py::object &out) {
+              double s_designDims::*xDimension = dimension(xName);
+              double s_designDims::*yDimension = dimension(yName);
+              if (xValues.ndim() != 1 || yValues.ndim() != 1)
+                  throw py::value_error("x_values and y_values must be 1D");
+              int xCount = static_cast<int>(xValues.size());
+              int yCount = static_cast<int>(yValues.size());
+              OutArray result = outputArray({xCount, yCount}, out);
+              const double *xs = xValues.data();
+              const double *ys = yValues.data();
+              double *dst = result.mutable_data();
+              {
+                  py::gil_scoped_release release;
+                  SVE::metricGrid(base, xDimension, xs, xCount, yDimension, ys, yCount, metric, ret, dst);
+              }
+              return result;
+          }, py::arg("base"), py::arg("x_dimension"), py::arg("x_values"), py::arg("y_dimension"), py::arg("y_values"),
+          py::arg("metric"), py::arg("ret") = false, py::arg("out") = py::none(),
+          "figure of merit over a grid of two design dimensions, (len(x_values), len(y_values)) array, NaN for invalid designs");
+}
@@ -22133,6 +22133,8 @@ void QCPCurve::draw(QCPPainter *painter)
     
     QCPDataRange lineDataRange = isSelectedSegment ? allSegments.at(i) : allSegments.at(i).adjusted(-1, 1); // unselected segments extend lines to bordering selected data point (safe to exceed total data bounds in first/last segment, getCurveLines takes care)
     getCurveLines(&lines, lineDataRange, finalCurvePen.widthF());
+    if (lines.isEmpty() && mScatterStyle.isNone() && !isSelectedSegment)
+      continue; // nothing of this segment is visible
     
     // check data validity if flag set:
   #ifdef QCUSTOMPLOT_CHECK_DATA
@@ -22268,6 +22270,10 @@ void QCPCurve::drawScatterPlot(QCPPainter *painter, const QVector<QPointF> &poin
   function. This is needed here to calculate an accordingly wider margin around the axis rect when
   performing the line optimization.
 
+  Curves with at most \ref smallCurveSize points in \a dataRange skip the optimization when their
+  bounding box is entirely inside the (margin extended) axis rect, their points are mapped
+  directly. When the bounding box is entirely outside, \a lines is left empty.
+
   Methods that are also involved in the algorithm are: \ref getRegion, \ref getOptimizedPoint, \ref
   getOptimizedCornerPoints \ref mayTraverse, \ref getTraverse, \ref getTraverseCornerPoints.
 
@@ -22292,6 +22298,39 @@ void QCPCurve::getCurveLines(QVector<QPointF> *lines, const QCPDataRange &dataRa
   mDataContainer->limitIteratorsToDataRange(itBegin, itEnd, dataRange);
   if (itBegin == itEnd)
     return;
+  
+  // small curves (e.g. the closed outlines of a diagram) are checked against the rect as a whole first:
+  if (itEnd-itBegin <= smallCurveSize)
+  {
+    double boundsKeyMin = itBegin->key, boundsKeyMax = itBegin->key;
+    double boundsValueMin = itBegin->value, boundsValueMax = itBegin->value;
+    for (QCPCurveDataContainer::const_iterator it = itBegin+1; it != itEnd; ++it)
+    {
+      boundsKeyMin = qMin(boundsKeyMin, it->key);
+      boundsKeyMax = qMax(boundsKeyMax, it->key);
+      boundsValueMin = qMin(boundsValueMin, it->value);
+      boundsValueMax = qMax(boundsValueMax, it->value);
+    }
+    // entirely outside, neither the line nor the fill can reach the visible rect:
+    if (boundsKeyMax < keyMin || boundsKeyMin > keyMax || boundsValueMax < valueMin || boundsValueMin > valueMax)
+      return;
+    // entirely inside (every point in region 5), the optimization below would return all points unchanged:
+    if (boundsKeyMin >= keyMin && boundsKeyMax <= keyMax && boundsValueMin >= valueMin && boundsValueMax <= valueMax)
+    {
+      lines->reserve(int(itEnd-itBegin));
+      if (keyAxis->orientation() == Qt::Horizontal)
+      {
+        for (QCPCurveDataContainer::const_iterator it = itBegin; it != itEnd; ++it)
+          lines->append(QPointF(keyAxis->coordToPixel(it->key), valueAxis->coordToPixel(it->value)));
+      } else
+      {
+        for (QCPCurveDataContainer::const_iterator it = itBegin; it != itEnd; ++it)
+          lines->append(QPointF(valueAxis->coordToPixel(it->value), keyAxis->coordToPixel(it->key)));
+      }
+      return;
+    }
+  }
+  
   QCPCurveDataContainer::const_iterator it = itBegin;
   QCPCurveDataContainer::const_iterator prevIt = itEnd-1;
   int prevRegion = getRegion(prevIt->key, prevIt->value, keyMin, valueMax, keyMax, valueMin);
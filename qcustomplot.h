@@ -68,6 +68,7 @@
 #include <qmath.h>
 #include <limits>
 #include <algorithm>
+#include <utility>
 #ifdef QCP_OPENGL_FBO
 #  include <QtGui/QOpenGLContext>
 #  include <QtGui/QOpenGLFramebufferObject>
@@ -2428,6 +2429,7 @@ public:
   // non-virtual methods:
   void set(const QCPDataContainer<DataType> &data);
   void set(const QVector<DataType> &data, bool alreadySorted=false);
+  void adopt(QVector<DataType> &&data);
   void add(const QCPDataContainer<DataType> &data);
   void add(const QVector<DataType> &data, bool alreadySorted=false);
   void add(const DataType &data);
@@ -2662,6 +2664,27 @@ void QCPDataContainer<DataType>::set(const QVector<DataType> &data, bool already
     sort();
 }
 
+/*!
+  Takes over the buffer of \a data as the data of this container, without copying or sorting it.
+  \a data is left empty.
+
+  The data points in \a data must already be in ascending order with respect to the DataType's
+  sort key. This is the cheapest way to replace large data sets that are generated in order, e.g.
+  a curve built directly as a QVector<QCPGraphData>: the only allocation is the one made while
+  building the buffer. To share a buffer that is kept elsewhere (e.g. cached), use \ref set with
+  \a alreadySorted instead, which shares the implicitly shared QVector until either side changes.
+
+  \see set
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::adopt(QVector<DataType> &&data)
+{
+  mData = std::move(data);
+  data.clear();
+  mPreallocSize = 0;
+  mPreallocIteration = 0;
+}
+
 /*! \overload
   
   Adds the provided \a data to the current data in this container.
@@ -5362,6 +5385,7 @@ protected:
   virtual void drawScatterPlot(QCPPainter *painter, const QVector<QPointF> &points, const QCPScatterStyle &style) const;
   
   // non-virtual methods:
+  static const int smallCurveSize = 64; // curves up to this many points are tested against the axis rect as a whole in getCurveLines
   void getCurveLines(QVector<QPointF> *lines, const QCPDataRange &dataRange, double penWidth) const;
   void getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataRange, double scatterWidth) const;
   int getRegion(double key, double value, double keyMin, double valueMax, double keyMax, double valueMin) const;
@@ -1,27 +1,65 @@
 QT       += core gui
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport concurrent svg
 
-CONFIG += c++11
+CONFIG += c++17
 
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    animationexporter.cpp \
     bilgramdialog.cpp \
+    cyclediagram.cpp \
+    designbatch.cpp \
+    designcomparison.cpp \
+    designfile.cpp \
+    designhistory.cpp \
+    designindex.cpp \
+    designsweep.cpp \
+    dynamicsimulation.cpp \
+    enginesnapshot.cpp \
+    heatmapview.cpp \
+    kinematictable.cpp \
     main.cpp \
     mainwindow.cpp \
     mycustomplot.cpp \
+    perfhud.cpp \
+    portflow.cpp \
     qcustomplot.cpp \
-    slidevalveengine.cpp
+    slidevalveengine.cpp \
+    steammap.cpp \
+    surrogate.cpp \
+    tracing.cpp \
+    valvediagram.cpp
 
 HEADERS += \
+    animationexporter.h \
     bilgramdialog.h \
+    cyclediagram.h \
+    designbatch.h \
+    designcomparison.h \
+    designfile.h \
+    designhistory.h \
+    designindex.h \
+    designsweep.h \
+    dynamicsimulation.h \
+    enginesnapshot.h \
+    heatmapview.h \
+    fixedgeometryengine.h \
+    kdtree.h \
+    kinematictable.h \
     mainwindow.h \
     mycustomplot.h \
+    perfhud.h \
+    portflow.h \
     qcustomplot.h \
-    slidevalveengine.h
+    slidevalveengine.h \
+    steammap.h \
+    surrogate.h \
+    tracing.h \
+    valvediagram.h
 
 FORMS += \
     bilgramdialog.ui \
@@ -1,56 +1,71 @@
 #include "slidevalveengine.h"
+#include "kinematictable.h"
 
-bool SVE::comparePointsLT(std::pair<double, int> point1, std::pair<double, int> point2){
+template <typename T>
+bool SVE::comparePointsLT(std::pair<T, int> point1, std::pair<T, int> point2){
  return point1.first < point2.first;
 }
 
-bool comparePointEQ(std::pair<double, int> point, double val){
+template <typename T>
+bool SVE::comparePointEQ(std::pair<T, int> point, typename Scalar<T>::type val){
     return point.first == val;
 }
 
-double SVE::deg2Rad(double deg)
-{
-    return deg * M_PI / 180.0;
-}
-
-double SVE:: rad2Deg(double rad)
+/*!
+ * calculate stroke position given grankshaft position in degrees.
+ * stroke position is measured from 0 at Top Dead Center (TDC)
+ * \param deg       crankshaft position in degrees measured from 0 at TDC
+ * \param stroke    Total stroke
+ * \param length    Connecting rod length
+ * \return          stroke position
+ */
+template <typename T>
+T SVE::crank2Stroke(T deg, typename Scalar<T>::type stroke, typename Scalar<T>::type length)
 {
-    return rad * 180.0 * M_1_PI;
+    // returns the stroke position offset from TDC for a given crank position
+    // crank position angle is measured from 0 at TDC
+    // from piston motion equations, x = distance from crankshaft to crosshead/piston
+    T r = stroke / T(2.0);
+    T rSin = r*std::sin(SVE::deg2Rad(deg));
+    T x = r * std::cos(SVE::deg2Rad(deg)) + std::sqrt(length*length - rSin*rSin);
+    // piston position(from TDC) = x(tdc) - x(angle)
+    return length + r - x;
 }
 
 /*!
- * adds degree angles with wrapping so result is 0 to 360
- * \param deg1 first angle in degrees
- * \param deg2 second angle in degrees
- * \return restricted angle in degrees
+ * calculate the rate of change of stroke position with crankshaft position
+ * \param deg       crankshaft position in degrees measured from 0 at TDC
+ * \param stroke    Total stroke
+ * \param length    Connecting rod length
+ * \return          derivative of crank2Stroke in stroke units per degree
  */
-double SVE::addAngles(double deg1, double deg2)
+template <typename T>
+T SVE::crank2StrokeSlope(T deg, typename Scalar<T>::type stroke, typename Scalar<T>::type length)
 {
-    double rawSum = deg1 + deg2;
-    double wrapped = fmod(rawSum, 360.0);
-    if (wrapped < 0)
-        return 360.0 + wrapped;
-    else
-        return wrapped;
+    // d/dtheta of r*cos(theta) + sqrt(l^2 - r^2*sin(theta)^2), negated
+    T r = stroke / T(2.0);
+    T rSin = r*std::sin(SVE::deg2Rad(deg));
+    T dxdRad = rSin + rSin * r*std::cos(SVE::deg2Rad(deg)) / std::sqrt(length*length - rSin*rSin);
+    return SVE::deg2Rad(dxdRad);
 }
 
 /*!
- * calculate stroke position given grankshaft position in degrees.
- * stroke position is measured from 0 at Top Dead Center (TDC)
+ * calculate the second derivative of stroke position with crankshaft position (the acceleration at a constant crank speed)
  * \param deg       crankshaft position in degrees measured from 0 at TDC
  * \param stroke    Total stroke
  * \param length    Connecting rod length
- * \return          double stroke position
+ * \return          second derivative of crank2Stroke in stroke units per degree^2
  */
-double SVE::crank2Stroke(double deg, double stroke, double length)
+template <typename T>
+T SVE::crank2StrokeAccel(T deg, typename Scalar<T>::type stroke, typename Scalar<T>::type length)
 {
-    // returns the stroke position offset from TDC for a given crank position
-    // crank position angle is measured from 0 at TDC
-    // from piston motion equations, x = distance from crankshaft to crosshead/piston
-    double r = stroke / 2.0;
-    double x = r * std::cos(SVE::deg2Rad(deg)) + std::sqrt(std::pow(length, 2) - std::pow(r*std::sin(SVE::deg2Rad(deg)), 2));
-    // piston position(from TDC) = x(tdc) - x(angle)
-    return length + r - x;
+    // d/dtheta of crank2StrokeSlope's r*sin + r^2*sin*cos / sqrt(l^2 - r^2*sin^2)
+    T r = stroke / T(2.0);
+    T c = std::cos(SVE::deg2Rad(deg));
+    T rSin = r*std::sin(SVE::deg2Rad(deg));
+    T s = std::sqrt(length*length - rSin*rSin);
+    T d2xdRad2 = r*c + (r*r*c*c - rSin*rSin) / s + rSin*rSin * r*r*c*c / (s*s*s);
+    return SVE::deg2Rad(SVE::deg2Rad(d2xdRad2));
 }
 
 /*!
@@ -61,58 +76,46 @@ double SVE::crank2Stroke(double deg, double stroke, double length)
  * \param length    Connecting rod length
  * \param ret       if true, the crankshaft position is calculated assuming the return stroke (return value will be between 180 and 360)
  */
-double SVE::stroke2Crank(double pos, double stroke, double length, bool ret)
+template <typename T>
+T SVE::stroke2Crank(T pos, typename Scalar<T>::type stroke, typename Scalar<T>::type length, bool ret)
 {
-    double r = stroke / 2.0;              // crank circle radius
+    T r = stroke / T(2.0);              // crank circle radius
 
     // trap for the extreams
     if (pos <= 0)
     {
-        return 0.0;
+        return T(0.0);
     }
     else if (pos >= stroke)
     {
-        return 180.0;
+        return T(180.0);
     }
 
     // use Law of Cosines to find the crank angle
     // l^2 = r^2+x^2 - 2rxCos(theta)
-    double x = (length + r) - pos;                            // distance from crankshaft to write pin
-    double arg = (x*x + r*r - length*length)/(2*r*x);
-    double a = SVE::rad2Deg(std::acos(arg));
+    T x = (length + r) - pos;                            // distance from crankshaft to write pin
+    T arg = (x*x + r*r - length*length)/(2*r*x);
+    T a = SVE::rad2Deg(std::acos(arg));
 
     //correct for return stroke
     if (ret)    // modify for return stroke
-        return 360.0 - a;
+        return T(360.0) - a;
     else
         return a;
 }
 
 
-SlideValveEngine::SlideValveEngine()
+template <typename T>
+SlideValveEngineT<T>::SlideValveEngineT()
 {
     // fill in some  known good default values
-    _engineParams.bore = 7;
-    _engineParams.stroke = 8.54;
-    _engineParams.conRod = 22.375;
-    _engineParams.valveTravel = 2.282;
-    _engineParams.valveConRod = 22;
-    _engineParams.eccentricAdvance = 120.0;
-    _engineParams.valvePorts.topPort[0] = -1.07;
-    _engineParams.valvePorts.topPort[1] = -1.725;
-    _engineParams.valvePorts.botPort[0] = 1.07;
-    _engineParams.valvePorts.botPort[1] = 1.725;
-    _engineParams.valvePorts.exPort[0] = .55;
-    _engineParams.valvePorts.exPort[1] = -.55;
-    _engineParams.valveSlide.topLand[0] = -1.06;
-    _engineParams.valveSlide.topLand[1] = -2.33;
-    _engineParams.valveSlide.botLand[0] = .9;
-    _engineParams.valveSlide.botLand[1] = 2.33;
+    _engineParams = SVE::defaultEngineParams<T>();
 
     calcCriticalPoints(_engineParams);
 }
 
-SlideValveEngine::SlideValveEngine(s_engineParams params)
+template <typename T>
+SlideValveEngineT<T>::SlideValveEngineT(s_engineParamsT<T> params)
 {
     if (validateSettings(params) == ErrorEnum::none)    // validate calls calcCriticalPoints
     {
@@ -121,48 +124,19 @@ SlideValveEngine::SlideValveEngine(s_engineParams params)
     else
     {
         // fill in some known good default values
-        _engineParams.bore = 7;
-        _engineParams.stroke = 8.54;
-        _engineParams.conRod = 22.375;
-        _engineParams.valveTravel = 2.282;
-        _engineParams.valveConRod = 22;
-        _engineParams.eccentricAdvance = 120.0;
-        _engineParams.valvePorts.topPort[0] = -1.07;
-        _engineParams.valvePorts.topPort[1] = -1.725;
-        _engineParams.valvePorts.botPort[0] = 1.07;
-        _engineParams.valvePorts.botPort[1] = 1.725;
-        _engineParams.valvePorts.exPort[0] = .55;
-        _engineParams.valvePorts.exPort[1] = -.55;
-        _engineParams.valveSlide.topLand[0] = -1.06;
-        _engineParams.valveSlide.topLand[1] = -2.33;
-        _engineParams.valveSlide.botLand[0] = .9;
-        _engineParams.valveSlide.botLand[1] = 2.33;
+        _engineParams = SVE::defaultEngineParams<T>();
         calcCriticalPoints(_engineParams);
     }
-
 }
 
-ErrorEnum SlideValveEngine::validateSettings(s_engineParams params)
+template <typename T>
+ErrorEnum SlideValveEngineT<T>::validateSettings(s_engineParamsT<T> params)
 {
-    // check the basic stuff
-    if (params.conRod <= params.stroke)
-        return ErrorEnum::error;
-    if (params.valveConRod <= params.valveTravel)
+    // check the basic stuff and the valve porting
+    if (SVE::checkGeometry(params) != ErrorEnum::none)
         return ErrorEnum::error;
 
-    //valve porting checks
-    if (params.valvePorts.topPort[0] <= params.valvePorts.topPort[1])    // top port values reversed
-        return ErrorEnum::error;
-    if (params.valvePorts.exPort[0] <= params.valvePorts.exPort[1])      // exahust port values reversed
-        return ErrorEnum::error;
-    if (params.valvePorts.botPort[1] <= params.valvePorts.botPort[0])    // bot port values reversed
-        return ErrorEnum::error;
-    if (params.valvePorts.topPort[0] >= params.valvePorts.exPort[1])    // top bridge is <=0
-        return ErrorEnum::error;
-    if (params.valvePorts.botPort[0] <= params.valvePorts.exPort[0])    // bot bridge is <=0
-        return ErrorEnum::error;
-
-    // TODO: check for exahust restriction if exahust port is too narrow
+    // a narrow exahust port restricts the flow but the engine still runs, so it is reported by exahustBottleneck() rather than rejected here
 
     // check that critical points calculate ok
     ErrorEnum err = calcCriticalPoints(params);     // if this returns no error, critical points are updated
@@ -172,43 +146,44 @@ ErrorEnum SlideValveEngine::validateSettings(s_engineParams params)
     return ErrorEnum::none;
 }
 
-s_engineParams SlideValveEngine::getEngineParams()
+template <typename T>
+s_engineParamsT<T> SlideValveEngineT<T>::getEngineParams() const
 {
     return _engineParams;
 }
 
-ErrorEnum SlideValveEngine::setEngineParams(s_engineParams newParams)
+template <typename T>
+ErrorEnum SlideValveEngineT<T>::setEngineParams(s_engineParamsT<T> newParams)
 {
     ErrorEnum ret = validateSettings(newParams);    // validate calls calcCriticalPoints
     if (ret == ErrorEnum::none){
         _engineParams = newParams;
+        // tables of other dimensions no longer apply. They are not looked up again until prepareTables()
+        if (_strokeTable && (_strokeTable->stroke() != newParams.stroke || _strokeTable->length() != newParams.conRod))
+            _strokeTable.reset();
+        if (_valveTable && (_valveTable->stroke() != newParams.valveTravel || _valveTable->length() != newParams.valveConRod))
+            _valveTable.reset();
     }
     return ret;
 }
 
-ErrorEnum SlideValveEngine::calcCriticalPoints(s_engineParams params){
-    double offsetFIO;                 // linear position offset from valve neutral for forward intake/cutoff
-    double offsetFRC;                 // linear position offset from valve neutral for forward release/compression
-    double offsetRIO;                 // linear position offset from valve neutral for reverse intake/cutoff
-    double offsetRRC;                 // linear position offset from valve neutral for reverse release/compression
-    double ecc[8];
-
-    // calculate offsets
-    offsetFIO = params.valvePorts.topPort[1] - params.valveSlide.topLand[1];
-    offsetFRC = params.valvePorts.topPort[0] - params.valveSlide.topLand[0];
-    offsetRIO = params.valvePorts.botPort[1] - params.valveSlide.botLand[1];
-    offsetRRC = params.valvePorts.botPort[0] - params.valveSlide.botLand[0];
-
+/*!
+ * picks up the shared kinematic tables for the current dimensions, building them if the dimensions are new.
+ * Call before many position queries of one design (plotting, animation). Without it the positions are calculated
+ * directly, which is cheaper for the handful of queries a metric or sweep point needs.
+ */
+template <typename T>
+void SlideValveEngineT<T>::prepareTables()
+{
+    if (!_strokeTable)
+        _strokeTable = SVE::CrankTable<T>::get(_engineParams.stroke, _engineParams.conRod);
+    if (!_valveTable)
+        _valveTable = SVE::CrankTable<T>::get(_engineParams.valveTravel, _engineParams.valveConRod);
+}
 
-    // calculate points
-    ecc[0] = SVE::addAngles(SVE::stroke2Crank(params.valveTravel/2 + offsetFIO, params.valveTravel, params.valveConRod, false), -params.eccentricAdvance);
-    ecc[1] = SVE::addAngles(SVE::stroke2Crank(params.valveTravel/2 + offsetFIO, params.valveTravel, params.valveConRod, true), -params.eccentricAdvance);
-    ecc[2] = SVE::addAngles(SVE::stroke2Crank(params.valveTravel/2 + offsetFRC, params.valveTravel, params.valveConRod, true), -params.eccentricAdvance);
-    ecc[3] = SVE::addAngles(SVE::stroke2Crank(params.valveTravel/2 + offsetFRC, params.valveTravel, params.valveConRod, false), -params.eccentricAdvance);
-    ecc[4] = SVE::addAngles(SVE::stroke2Crank(params.valveTravel/2 + offsetRIO, params.valveTravel, params.valveConRod, true), -params.eccentricAdvance);
-    ecc[5] = SVE::addAngles(SVE::stroke2Crank(params.valveTravel/2 + offsetRIO, params.valveTravel, params.valveConRod, false), -params.eccentricAdvance);
-    ecc[6] = SVE::addAngles(SVE::stroke2Crank(params.valveTravel/2 + offsetRRC, params.valveTravel, params.valveConRod, false), -params.eccentricAdvance);
-    ecc[7] = SVE::addAngles(SVE::stroke2Crank(params.valveTravel/2 + offsetRRC, params.valveTravel, params.valveConRod, true), -params.eccentricAdvance);
+template <typename T>
+ErrorEnum SlideValveEngineT<T>::calcCriticalPoints(s_engineParamsT<T> params){
+    auto ecc = SVE::criticalPoints(params, SVE::stroke2Crank<T>);
 
     _criticalPoints[0] = ecc[0];
     _criticalPoints[1] = ecc[1];
@@ -238,138 +213,104 @@ ErrorEnum SlideValveEngine::calcCriticalPoints(s_engineParams params){
 }
 
 
-double SlideValveEngine::stroke2Crank(double pos, bool ret)
+template <typename T>
+T SlideValveEngineT<T>::stroke2Crank(T pos, bool ret) const
 {
+    if (_strokeTable)
+        return _strokeTable->stroke2Crank(pos, ret);
     return SVE::stroke2Crank(pos, _engineParams.stroke, _engineParams.conRod, ret);
 }
 
-double SlideValveEngine::crank2Stroke(double deg)
+template <typename T>
+T SlideValveEngineT<T>::crank2Stroke(T deg) const
 {
+    if (_strokeTable)
+        return _strokeTable->crank2Stroke(deg);
     return SVE::crank2Stroke(deg, _engineParams.stroke, _engineParams.conRod);
 }
 
-double SlideValveEngine::valvePos2Crank(double pos, bool ret)
+template <typename T>
+T SlideValveEngineT<T>::valvePos2Crank(T pos, bool ret) const
 {
     // valve position is measured relative to neutral, so convert to position from TDC
-    double posFromTDC = pos + (_engineParams.valveTravel/2.0);
+    T posFromTDC = pos + (_engineParams.valveTravel/T(2.0));
     //now use the standard piston motion call
-    double eccentricAngle = SVE::stroke2Crank(posFromTDC, _engineParams.valveTravel, _engineParams.valveConRod, ret);
+    T eccentricAngle;
+    if (_valveTable)
+        eccentricAngle = _valveTable->stroke2Crank(posFromTDC, ret);
+    else
+        eccentricAngle = SVE::stroke2Crank(posFromTDC, _engineParams.valveTravel, _engineParams.valveConRod, ret);
     // apply offset to get crankshaft angle
     return SVE::addAngles(eccentricAngle, -_engineParams.eccentricAdvance);
 }
 
-double SlideValveEngine::crank2ValvePos(double deg)
+template <typename T>
+T SlideValveEngineT<T>::crank2ValvePos(T deg) const
 {
     // convert crankshaft angle to eccentric angle
-    double eccAngle = SVE::addAngles(deg, _engineParams.eccentricAdvance);
+    T eccAngle = SVE::addAngles(deg, _engineParams.eccentricAdvance);
     // get valve offset from TDC
-    double posFromTDC = SVE::crank2Stroke(eccAngle, _engineParams.valveTravel, _engineParams.valveConRod);
+    T posFromTDC;
+    if (_valveTable)
+        posFromTDC = _valveTable->crank2Stroke(eccAngle);
+    else
+        posFromTDC = SVE::crank2Stroke(eccAngle, _engineParams.valveTravel, _engineParams.valveConRod);
     // convert to valve position from neutral
-    return posFromTDC - (_engineParams.valveTravel/2.0);
+    return posFromTDC - (_engineParams.valveTravel/T(2.0));
+}
+
+template <typename T>
+T SlideValveEngineT<T>::crank2ValveSlope(T deg) const
+{
+    return SVE::crank2StrokeSlope(SVE::addAngles(deg, _engineParams.eccentricAdvance), _engineParams.valveTravel, _engineParams.valveConRod);
 }
 
-CycleEnum SlideValveEngine::crank2TopCycle(double deg){
+template <typename T>
+T SlideValveEngineT<T>::crank2ValveAccel(T deg) const
+{
+    return SVE::crank2StrokeAccel(SVE::addAngles(deg, _engineParams.eccentricAdvance), _engineParams.valveTravel, _engineParams.valveConRod);
+}
+
+template <typename T>
+CycleEnum SlideValveEngineT<T>::crank2TopCycle(T deg) const{
     return crank2Cycle(deg, false);
 }
 
-CycleEnum SlideValveEngine::crank2BotCycle(double deg)
+template <typename T>
+CycleEnum SlideValveEngineT<T>::crank2BotCycle(T deg) const
 {
     return crank2Cycle(deg, true);
 }
 
-CycleEnum SlideValveEngine::crank2Cycle(double deg, bool ret)
+template <typename T>
+CycleEnum SlideValveEngineT<T>::crank2Cycle(T deg, bool ret) const
 {
-    CycleEnum cycle = CycleEnum::intake;    
-
-    // calculate wrapped angle
-    double wrapped = SVE::addAngles(deg, 0);
-
     // compare with critical points to find region
-    std::array<double, 4> critP;
     if (ret)
-        critP = botCriticalPoints();
+        return SVE::cycleRegion(deg, botCriticalPoints());
     else
-        critP = topCriticalPoints();
-
-    // find (crit - wrapped) for all crit (crit >=0 by definition)
-    std::array<double, 4> diffs;
-    for (int i=0; i<4; i++)
-        diffs[i] = critP[i] - wrapped;
-
-    // if any exact match choose the match
-    int startPoint = 0;
-    if (diffs[0] == 0){
-        startPoint = 0;
-    }else if (diffs[1] == 0){
-        startPoint = 1;
-    }else if (diffs[2] == 0){
-        startPoint = 2;
-    }else if (diffs[3] == 0){
-        startPoint = 3;
-    }else if (diffs[0] > 0 && diffs[1] > 0 && diffs[2] > 0 && diffs[3] > 0){ // if all diff + choose largest
-        double maxDiff = 0;
-        for (int i=0; i<4; i++){
-            if (diffs[i] > maxDiff){
-                maxDiff = diffs[i];
-                startPoint = i;
-            }
-        }
-    }else{ // if any - choose largest that is < 0
-        double maxDiff = -1000;
-        for (int i=0; i<4; i++){
-            if (diffs[i] < 0 && diffs[i] > maxDiff){
-                maxDiff = diffs[i];
-                startPoint = i;
-            }
-        }
-    }
-
-    switch (startPoint){
-    case 1:
-        cycle = CycleEnum::expansion;
-        break;
-    case 2:
-        cycle = CycleEnum::exahust;
-        break;
-    case 3:
-        cycle = CycleEnum::compression;
-        break;
-    default:
-        cycle = CycleEnum::intake;
-        break;
-    }
-
-    return cycle;
+        return SVE::cycleRegion(deg, topCriticalPoints());
 }
 
-int SlideValveEngine::nextTopCriticalPoint(double deg)
+template <typename T>
+int SlideValveEngineT<T>::nextTopCriticalPoint(T deg) const
 {
     return nextPoint(deg, topCriticalPoints());
 }
 
-int SlideValveEngine::nextBotCriticalPoint(double deg)
+template <typename T>
+int SlideValveEngineT<T>::nextBotCriticalPoint(T deg) const
 {
     return nextPoint(deg, botCriticalPoints());
 }
 
-int SlideValveEngine::nextPoint(double deg, std::array<double, 4> points){
-    std::array<std::pair<double, int>, 4> newPoints;                        // array of pairs to keep track of original index
-    newPoints[0] = std::make_pair(points[0], 0);
-    newPoints[1] = std::make_pair(points[1], 1);
-    newPoints[2] = std::make_pair(points[2], 2);
-    newPoints[3] = std::make_pair(points[3], 3);
-
-    std::sort(newPoints.begin(), newPoints.end(), SVE::comparePointsLT);                      // sort into acending order
-    double wrapped = SVE::addAngles(deg, 0);                                //get wrapped version of deg
-    for (int i=0; i<4; i++)                                                 // search the sorted points for the first larger than wrapped
-        if (newPoints[i].first > wrapped){                                  // found the next point
-            return newPoints[i].second;
-        }
-    // didn't find a next, must wrap around to the beginning
-    return newPoints[0].second;
+template <typename T>
+int SlideValveEngineT<T>::nextPoint(T deg, std::array<T, 4> points) const{
+    return SVE::nextPoint(deg, points);
 }
 
-double SlideValveEngine::crankInlet(bool ret)                              // returns the crank position when the steam port opens in radians. if ret is true, returns the value for the return stroke
+template <typename T>
+T SlideValveEngineT<T>::crankInlet(bool ret) const                              // returns the crank position when the steam port opens in radians. if ret is true, returns the value for the return stroke
 {
     if (ret)
         return _criticalPoints[0];
@@ -377,7 +318,8 @@ double SlideValveEngine::crankInlet(bool ret)                              // re
         return _criticalPoints[0];
 }
 
-double SlideValveEngine::crankCutoff(bool ret)                             // returns the crank position when the steam port closes in radians. if ret is true, returns the value for the return stroke
+template <typename T>
+T SlideValveEngineT<T>::crankCutoff(bool ret) const                             // returns the crank position when the steam port closes in radians. if ret is true, returns the value for the return stroke
 {
     if (ret)
         return _criticalPoints[1];
@@ -385,7 +327,8 @@ double SlideValveEngine::crankCutoff(bool ret)                             // re
         return _criticalPoints[1];
 }
 
-double SlideValveEngine::crankRelease(bool ret)                            // returns the crank position when the exahust port opens in radians. if ret is true, returns the value for the return stroke
+template <typename T>
+T SlideValveEngineT<T>::crankRelease(bool ret) const                            // returns the crank position when the exahust port opens in radians. if ret is true, returns the value for the return stroke
 {
     if (ret)
         return _criticalPoints[2];
@@ -393,7 +336,8 @@ double SlideValveEngine::crankRelease(bool ret)                            // re
         return _criticalPoints[2];
 }
 
-double SlideValveEngine::crankCompression(bool ret)                        // returns the crank position when the exahust port closes in radians. if ret is true, returns the value for the return stroke
+template <typename T>
+T SlideValveEngineT<T>::crankCompression(bool ret) const                        // returns the crank position when the exahust port closes in radians. if ret is true, returns the value for the return stroke
 {
     if (ret)
         return _criticalPoints[3];
@@ -401,9 +345,10 @@ double SlideValveEngine::crankCompression(bool ret)                        // re
         return _criticalPoints[3];
 }
 
-std::array<double, 4> SlideValveEngine::topCriticalPoints()
+template <typename T>
+std::array<T, 4> SlideValveEngineT<T>::topCriticalPoints() const
 {
-    std::array<double, 4> foo;
+    std::array<T, 4> foo;
     foo[0] = _criticalPoints[0];
     foo[1] = _criticalPoints[1];
     foo[2] = _criticalPoints[2];
@@ -411,9 +356,10 @@ std::array<double, 4> SlideValveEngine::topCriticalPoints()
     return foo;
 }
 
-std::array<double, 4> SlideValveEngine::botCriticalPoints()
+template <typename T>
+std::array<T, 4> SlideValveEngineT<T>::botCriticalPoints() const
 {
-    std::array<double, 4> foo;
+    std::array<T, 4> foo;
     foo[0] = _criticalPoints[4];
     foo[1] = _criticalPoints[5];
     foo[2] = _criticalPoints[6];
@@ -421,9 +367,10 @@ std::array<double, 4> SlideValveEngine::botCriticalPoints()
     return foo;
 }
 
-std::array<double, 8> SlideValveEngine::criticalPoints()
+template <typename T>
+std::array<T, 8> SlideValveEngineT<T>::criticalPoints() const
 {
-    std::array<double, 8> foo;
+    std::array<T, 8> foo;
     foo[0] = _criticalPoints[0];
     foo[1] = _criticalPoints[1];
     foo[2] = _criticalPoints[2];
@@ -434,3 +381,178 @@ std::array<double, 8> SlideValveEngine::criticalPoints()
     foo[7] = _criticalPoints[7];
     return foo;
 }
+
+
+template <typename T>
+SlideValveEngineT<T>::~SlideValveEngineT()
+{
+}
+
+/*!
+ * cylinder volume of one end of the cylinder (the piston rod is not taken out of the bottom end)
+ * \param deg       crankshaft position in degrees
+ * \param ret       if true, the bottom end
+ * \return clearance plus the volume swept from that end's dead center
+ */
+template <typename T>
+T SlideValveEngineT<T>::cylinderVolume(T deg, bool ret) const
+{
+    T area = SVE::pi<T>() * _engineParams.bore * _engineParams.bore / T(4.0);
+    T x = crank2Stroke(deg);
+    return _engineParams.clearance[ret ? 1 : 0] + area * (ret ? _engineParams.stroke - x : x);
+}
+
+/*!
+ * change of the cylinder volume of one end from inlet to cutoff
+ * \param ret       if true, calculates for the return stroke (bottom end)
+ */
+template <typename T>
+T SlideValveEngineT<T>::inletVolume(bool ret) const
+{
+    const T *points = ret ? _criticalPoints + 4 : _criticalPoints;
+    return cylinderVolume(points[1], ret) - cylinderVolume(points[0], ret);
+}
+
+/*!
+ * change of the cylinder volume of one end from cutoff to release
+ * \param ret       if true, calculates for the return stroke (bottom end)
+ */
+template <typename T>
+T SlideValveEngineT<T>::expansionVolume(bool ret) const
+{
+    const T *points = ret ? _criticalPoints + 4 : _criticalPoints;
+    return cylinderVolume(points[2], ret) - cylinderVolume(points[1], ret);
+}
+
+/*!
+ * volume the steam left in one end is compressed by, from the exahust closing to the end of compression
+ * \param ret       if true, calculates for the return stroke (bottom end)
+ */
+template <typename T>
+T SlideValveEngineT<T>::compressionVolume(bool ret) const
+{
+    const T *points = ret ? _criticalPoints + 4 : _criticalPoints;
+    return cylinderVolume(points[3], ret) - compressionEndVolume(ret);
+}
+
+template <typename T>
+T SlideValveEngineT<T>::compressionEndVolume(bool ret) const
+{
+    // compression runs from the exahust closing to the inlet opening. With lead the inlet opens before dead center and ends
+    // it there, otherwise the piston reaches dead center (just the clearance left) and the steam re-expands until the inlet opens
+    const T *points = ret ? _criticalPoints + 4 : _criticalPoints;
+    T deadCenter = ret ? T(180.0) : T(0.0);
+    if (SVE::addAngles(deadCenter, -points[3]) <= SVE::addAngles(points[0], -points[3]))
+        return _engineParams.clearance[ret ? 1 : 0];
+    return cylinderVolume(points[0], ret);
+}
+
+/*!
+ * compression ratio of the cushion steam of one end
+ * \param ret       if true, calculates for the return stroke (bottom end)
+ */
+template <typename T>
+T SlideValveEngineT<T>::cushionRatio(bool ret) const
+{
+    const T *points = ret ? _criticalPoints + 4 : _criticalPoints;
+    return cylinderVolume(points[3], ret) / compressionEndVolume(ret);
+}
+
+/*!
+ * cushion pressure of one end: the steam trapped at back pressure when the exahust closes, compressed into the clearance
+ * \param ret               if true, calculates for the return stroke (bottom end)
+ * \param exahustPressure   back pressure when the exahust closes (absolute)
+ * \param exponent          polytropic exponent of the compression, about 1.13 for saturated steam
+ * \return pressure at the end of compression. above the chest pressure the valve is lifted off its face
+ */
+template <typename T>
+T SlideValveEngineT<T>::cushionPressure(bool ret, T exahustPressure, T exponent) const
+{
+    return exahustPressure * std::pow(cushionRatio(ret), exponent);
+}
+
+/*!
+ * calculates a figure of merit of the design for one side of the piston
+ * \param metric    which figure to calculate
+ * \param ret       if true, calculates for the return stroke (bottom side of the piston)
+ * \return cutoff and compression in percent of stroke, leads as port opening (negative if the port is still closed)
+ */
+template <typename T>
+T SlideValveEngineT<T>::metric(MetricEnum metric, bool ret) const
+{
+    const T *points = ret ? _criticalPoints + 4 : _criticalPoints;      // inlet, cutoff, release, compression for this side
+    T stroke = _engineParams.stroke;
+
+    // valve positions (from neutral) where this side's ports open, same offsets as SVE::criticalPoints()
+    T inletOffset = ret ? _engineParams.valvePorts.botPort[1] - _engineParams.valveSlide.botLand[1]
+                        : _engineParams.valvePorts.topPort[1] - _engineParams.valveSlide.topLand[1];
+    T exahustOffset = ret ? _engineParams.valvePorts.botPort[0] - _engineParams.valveSlide.botLand[0]
+                          : _engineParams.valvePorts.topPort[0] - _engineParams.valveSlide.topLand[0];
+
+    switch (metric){
+    case MetricEnum::cutoff:
+        // forward stroke runs from TDC (0) to stroke, return stroke back again
+        return ret ? (stroke - crank2Stroke(points[1])) / stroke * T(100.0) : crank2Stroke(points[1]) / stroke * T(100.0);
+    case MetricEnum::lead:
+        // the top port takes steam with the valve above inletOffset, the bottom port below it
+        return ret ? inletOffset - crank2ValvePos(T(180.0)) : crank2ValvePos(T(0.0)) - inletOffset;
+    case MetricEnum::exahustLead:
+        // and exahausts on the other side of exahustOffset
+        return ret ? crank2ValvePos(T(0.0)) - exahustOffset : exahustOffset - crank2ValvePos(T(180.0));
+    case MetricEnum::compression:
+        return ret ? (stroke - crank2Stroke(points[3])) / stroke * T(100.0) : crank2Stroke(points[3]) / stroke * T(100.0);
+    case MetricEnum::exahustRestriction:
+        return exahustBottleneck(ret).ratio;
+    case MetricEnum::cushion:
+        return cushionRatio(ret);
+    }
+    return T(0.0);
+}
+
+/*!
+ * openings of the exahust path at a crank position
+ * \param deg       crankshaft position in degrees
+ * \param ret       if true, calculates for the return stroke (bottom port)
+ * \return the steam port and exahust port openings to the valve cavity, and the flow width of the path
+ */
+template <typename T>
+s_exahustFlowT<T> SlideValveEngineT<T>::exahustFlow(T deg, bool ret) const
+{
+    return SVE::exahustFlow(_engineParams, crank2ValvePos(deg), ret);
+}
+
+/*!
+ * narrowest exahust port opening while one side of the piston exahausts, see SVE::exahustBottleneck
+ * \param ret       if true, calculates for the return stroke (bottom side)
+ */
+template <typename T>
+s_exahustBottleneckT<T> SlideValveEngineT<T>::exahustBottleneck(bool ret) const
+{
+    return SVE::exahustBottleneck(_engineParams, ret);
+}
+
+/*!
+ * valve rod and eccentric strap loads at a crank position, see SVE::valveLoad
+ * \param deg       crankshaft position in degrees
+ * \param settings  pressures, friction, valve mass and crankshaft speed
+ */
+template <typename T>
+s_valveLoadT<T> SlideValveEngineT<T>::valveLoad(T deg, const s_valveLoadSettingsT<T> &settings) const
+{
+    T eccRad = SVE::deg2Rad(SVE::addAngles(deg, _engineParams.eccentricAdvance));
+    return SVE::valveLoad(_engineParams, settings, std::cos(eccRad), std::sin(eccRad));
+}
+
+// explicit instantiations for the supported scalar types
+#define SVE_INSTANTIATE(T) \
+    template T SVE::crank2Stroke<T>(T, T, T); \
+    template T SVE::crank2StrokeSlope<T>(T, T, T); \
+    template T SVE::crank2StrokeAccel<T>(T, T, T); \
+    template T SVE::stroke2Crank<T>(T, T, T, bool); \
+    template bool SVE::comparePointsLT<T>(std::pair<T, int>, std::pair<T, int>); \
+    template bool SVE::comparePointEQ<T>(std::pair<T, int>, T); \
+    template class SlideValveEngineT<T>;
+
+SVE_INSTANTIATE(float)
+SVE_INSTANTIATE(double)
+SVE_INSTANTIATE(long double)
@@ -4,33 +4,123 @@
 #include <tuple>
 #include <cmath>
 #include <algorithm>
+#include <array>
+#include <memory>
 
 
+// The engine model is templated on the scalar type <T>. float, double and long double are instantiated in slidevalveengine.cpp
+// double is the default used by the application, and has the plain (non suffixed) names below
+
 // valve measurements are from neutral position. neutral is positive direction form valve TDC
-typedef struct
+template <typename T>
+struct s_valvePortsT
+{
+    T topPort[2];      // distance from valve neutral position to the lower edge [0] and upper edge[1] of the top steam port ( both negative, closer to valve TDC than neutral )
+    T botPort[2];      // distance from valve neutral position to the lower edge [0] and upper edge[1] of the top steam port ( both positive, farther from valve TDC than neutral)
+    T exPort[2];       // distance from valve neutral position to the lower edge [0] and upper edge[1] of the exahust port ( lower positive, upper negative)
+};
+
+template <typename T>
+struct s_dValveT
+{
+    T topLand[2];      // distance from slide center to the top land edges [0]= inside edge, [1] = outside edge (both negative)
+    T botLand[2];      // distance from slide center to the bottom land edges [0]= inside edge, [1] = outside edge (both positive)
+};
+
+template <typename T>
+struct s_engineParamsT
+{
+    T bore;                // bore of the engine
+    T stroke;              // stroke of the engine
+    T conRod;              // length (pin to pin) of the piston connecting rod
+    T valveTravel;         // total valve travel (twice the eccentric offset)
+    T valveConRod;         // length (eccentric offset point to pin) of the valve connecting rod
+    T eccentricAdvance;    // advance in degrees of the eccentric from the crankshaft. (0 is TDC for crank, extream top position for valve)
+    s_valvePortsT<T> valvePorts;    // valve ports
+    s_dValveT<T> valveSlide;        // D-valve slider
+    T clearance[2];        // clearance volume of the top [0] and bottom [1] ends of the cylinder
+};
+
+// the design dimensions as they are entered (and saved). Ports and lands are symmetric about the valve center.
+// converted to/from s_engineParamsT with SVE::designParams() and SVE::designDims()
+template <typename T>
+struct s_designDimsT
+{
+    T bore;
+    T stroke;
+    T conRod;
+    T valveTravel;
+    T valveConRod;
+    T eccentricAdvance;
+    T steamPortWidth;      // width of each steam port
+    T steamPortSpace;      // center to center distance of the steam ports
+    T exahustPortWidth;    // width of the exahust port
+    T valveWidth;          // overall length of the slide
+    T valveTopLand;        // width of the top land
+    T valveBottomLand;     // width of the bottom land
+    T topClearance;        // clearance volume of the top end of the cylinder
+    T bottomClearance;     // clearance volume of the bottom end of the cylinder
+};
+
+// exahust path of one side of the piston: steam port -> cavity under the D-valve -> exahust port
+// widths are along the valve face, multiply by the port length for areas
+template <typename T>
+struct s_exahustFlowT
+{
+    T portOpening;         // part of the steam port open to the cavity
+    T exahustOpening;      // part of the exahust port open to the cavity
+    T width;               // flow width of the path, the smaller of the two (0 when the steam port is closed to the cavity)
+};
+
+// narrowest exahust port opening seen by one side while it exahausts, see SVE::exahustBottleneck()
+template <typename T>
+struct s_exahustBottleneckT
+{
+    T exahustOpening;      // smallest exahust port opening during the exahust period
+    T crank;               // crank angle where it occurs
+    T portOpening;         // steam port opening at the same angle
+    T ratio;               // exahustOpening / portOpening. below 1 the exahust port restricts the flow
+};
+
+// operating point for the valve gear loads, see SVE::valveLoad(). any consistent units (e.g. psi, inches, lbf s^2/in for the mass)
+template <typename T>
+struct s_valveLoadSettingsT
 {
-    double topPort[2];      // distance from valve neutral position to the lower edge [0] and upper edge[1] of the top steam port ( both negative, closer to valve TDC than neutral )
-    double botPort[2];      // distance from valve neutral position to the lower edge [0] and upper edge[1] of the top steam port ( both positive, farther from valve TDC than neutral)
-    double exPort[2];       // distance from valve neutral position to the lower edge [0] and upper edge[1] of the exahust port ( lower positive, upper negative)
-} s_valvePorts;
+    T chestPressure;       // steam chest pressure on the back of the slide
+    T exahustPressure;     // pressure in the valve cavity
+    T portLength;          // length of the ports across the valve face (the slide areas are widths * portLength)
+    T friction;            // friction coefficient between the slide and the valve face
+    T valveMass;           // slide, valve rod and the reciprocating part of the eccentric rod
+    T speed;               // crankshaft speed in rad/s
+};
 
-typedef struct
+// loads on the valve gear at one crank position. positive forces push the valve away from valve TDC
+template <typename T>
+struct s_valveLoadT
 {
-    double topLand[2];      // distance from slide center to the top land edges [0]= inside edge, [1] = outside edge (both negative)
-    double botLand[2];      // distance from slide center to the bottom land edges [0]= inside edge, [1] = outside edge (both positive)
-} s_dValve;
+    T normalForce;         // steam load pressing the slide onto the valve face
+    T friction;            // force needed to overcome the slide friction (opposes the valve velocity)
+    T inertia;             // force needed to accelerate the valve
+    T rodForce;            // valve rod force, friction + inertia
+    T strapForce;          // force along the eccentric rod, taken by the eccentric strap
+    T eccentricTorque;     // torque the valve gear takes from the crankshaft
+};
+
+typedef s_valvePortsT<double> s_valvePorts;
+typedef s_dValveT<double> s_dValve;
+typedef s_engineParamsT<double> s_engineParams;
+typedef s_designDimsT<double> s_designDims;
+typedef s_exahustFlowT<double> s_exahustFlow;
+typedef s_exahustBottleneckT<double> s_exahustBottleneck;
+typedef s_valveLoadSettingsT<double> s_valveLoadSettings;
+typedef s_valveLoadT<double> s_valveLoad;
 
-typedef struct
+// one design dimension: its name (also the design file column) and the member holding it, see SVE::designDimensions
+struct s_designDimension
 {
-    double bore;                // bore of the engine
-    double stroke;              // stroke of the engine
-    double conRod;              // length (pin to pin) of the piston connecting rod
-    double valveTravel;         // total valve travel (twice the eccentric offset)
-    double valveConRod;         // length (eccentric offset point to pin) of the valve connecting rod
-    double eccentricAdvance;    // advance in degrees of the eccentric from the crankshaft. (0 is TDC for crank, extream top position for valve)
-    s_valvePorts valvePorts;    // valve ports
-    s_dValve valveSlide;        // D-valve slider
-} s_engineParams;
+    const char *name;
+    double s_designDims::*member;
+};
 
 enum class ErrorEnum{
     none,
@@ -41,67 +131,547 @@ enum class CycleEnum{
     intake, expansion, exahust, compression
 };
 
+// design figures of merit, see SlideValveEngineT::metric()
+enum class MetricEnum{
+    cutoff,             // piston position at cutoff, percent of stroke
+    lead,               // steam port opening at dead center
+    exahustLead,        // exahust opening at the opposite dead center
+    compression,        // piston distance from dead center when the exahust closes, percent of stroke
+    exahustRestriction, // s_exahustBottleneckT::ratio, below 1 the exahust port is too narrow
+    cushion             // volume ratio of the compression, cushion pressure = back pressure * cushion^n
+};
+
 namespace SVE {
-    double rad2Deg(double rad);
-    double deg2Rad(double deg);
-    double crank2Stroke(double deg, double stroke, double length);
-    double stroke2Crank(double pos, double stroke, double length, bool ret);
-    double addAngles(double deg1, double deg2);
-    bool comparePointsLT(std::pair<double, int> point1, std::pair<double, int> point2);
-    bool comparePointEQ(std::pair<double, int> point, double val);
+    template <typename T> class CrankTable;
+
+    // holds T in a non-deduced context, so only the first argument picks the scalar type (keeps calls like addAngles(deg, 0) working)
+    template <typename T> struct Scalar { typedef T type; };
+
+    template <typename T> T crank2Stroke(T deg, typename Scalar<T>::type stroke, typename Scalar<T>::type length);
+    template <typename T> T crank2StrokeSlope(T deg, typename Scalar<T>::type stroke, typename Scalar<T>::type length);
+    template <typename T> T crank2StrokeAccel(T deg, typename Scalar<T>::type stroke, typename Scalar<T>::type length);
+    template <typename T> T stroke2Crank(T pos, typename Scalar<T>::type stroke, typename Scalar<T>::type length, bool ret);
+    template <typename T> bool comparePointsLT(std::pair<T, int> point1, std::pair<T, int> point2);
+    template <typename T> bool comparePointEQ(std::pair<T, int> point, typename Scalar<T>::type val);
+
+    /*!
+     * pi in the precision of <T>
+     */
+    template <typename T>
+    constexpr T pi()
+    {
+        return static_cast<T>(3.141592653589793238462643383279502884L);
+    }
+
+    template <typename T>
+    constexpr T deg2Rad(T deg)
+    {
+        return deg * pi<T>() / T(180.0);
+    }
+
+    template <typename T>
+    constexpr T rad2Deg(T rad)
+    {
+        return rad * T(180.0) * static_cast<T>(0.318309886183790671537767526745028724L);
+    }
+
+    /*!
+     * floating point remainder of x / y, matching std::fmod but usable in constant expressions
+     * (falls back to std::fmod for values too large to truncate through an integer)
+     */
+    template <typename T>
+    constexpr T fmod(T x, T y)
+    {
+        if (!(x < T(1e15) && x > T(-1e15)))
+            return std::fmod(x, y);
+        T r = x - y * static_cast<T>(static_cast<long long>(x / y));     // exact, apart from the truncated quotient possibly being off by one
+        if (x >= 0 && r < 0)
+            r += y;
+        else if (x < 0 && r > 0)
+            r -= y;
+        else if (r >= y)
+            r -= y;
+        else if (r <= -y)
+            r += y;
+        return r;
+    }
+
+    /*!
+     * adds degree angles with wrapping so result is 0 to 360
+     * \param deg1 first angle in degrees
+     * \param deg2 second angle in degrees
+     * \return restricted angle in degrees
+     */
+    template <typename T>
+    constexpr T addAngles(T deg1, typename Scalar<T>::type deg2)
+    {
+        T rawSum = deg1 + deg2;
+        T wrapped = SVE::fmod(rawSum, T(360.0));
+        if (wrapped < 0)
+            return T(360.0) + wrapped;
+        else
+            return wrapped;
+    }
+
+    /*!
+     * the known good geometry the engine starts with
+     */
+    template <typename T>
+    constexpr s_engineParamsT<T> defaultEngineParams()
+    {
+        return s_engineParamsT<T>{
+            T(7.0L),            // bore
+            T(8.54L),           // stroke
+            T(22.375L),         // conRod
+            T(2.282L),          // valveTravel
+            T(22.0L),           // valveConRod
+            T(120.0L),          // eccentricAdvance
+            {{T(-1.07L), T(-1.725L)}, {T(1.07L), T(1.725L)}, {T(.55L), T(-.55L)}},   // topPort, botPort, exPort
+            {{T(-1.06L), T(-2.33L)}, {T(.9L), T(2.33L)}},                            // topLand, botLand
+            {T(26.3L), T(26.3L)}                                                    // clearance, about 8% of the swept volume
+        };
+    }
+
+    /*!
+     * engine parameters for design dimensions
+     */
+    template <typename T>
+    constexpr s_engineParamsT<T> designParams(const s_designDimsT<T> &dims)
+    {
+        s_engineParamsT<T> params{};
+        params.bore = dims.bore;
+        params.stroke = dims.stroke;
+        params.conRod = dims.conRod;
+        params.valveTravel = dims.valveTravel;
+        params.valveConRod = dims.valveConRod;
+        params.eccentricAdvance = dims.eccentricAdvance;
+        params.valvePorts.topPort[0] = -(dims.steamPortSpace - dims.steamPortWidth) / 2;
+        params.valvePorts.botPort[0] = (dims.steamPortSpace - dims.steamPortWidth) / 2;
+        params.valvePorts.exPort[0] = dims.exahustPortWidth / 2;
+        params.valvePorts.topPort[1] = -(dims.steamPortSpace + dims.steamPortWidth) / 2;
+        params.valvePorts.botPort[1] = (dims.steamPortSpace + dims.steamPortWidth) / 2;
+        params.valvePorts.exPort[1] = -dims.exahustPortWidth / 2;
+        params.valveSlide.topLand[0] = -dims.valveWidth/2 + dims.valveTopLand;
+        params.valveSlide.botLand[0] = (dims.valveWidth/2) - dims.valveBottomLand;
+        params.valveSlide.topLand[1] = -dims.valveWidth/2;
+        params.valveSlide.botLand[1] = (dims.valveWidth/2);
+        params.clearance[0] = dims.topClearance;
+        params.clearance[1] = dims.bottomClearance;
+        return params;
+    }
+
+    /*!
+     * design dimensions of engine parameters, the inverse of designParams(). The bottom port and land set the symmetric dimensions
+     */
+    template <typename T>
+    constexpr s_designDimsT<T> designDims(const s_engineParamsT<T> &params)
+    {
+        s_designDimsT<T> dims{};
+        dims.bore = params.bore;
+        dims.stroke = params.stroke;
+        dims.conRod = params.conRod;
+        dims.valveTravel = params.valveTravel;
+        dims.valveConRod = params.valveConRod;
+        dims.eccentricAdvance = params.eccentricAdvance;
+        dims.steamPortWidth = params.valvePorts.botPort[1] - params.valvePorts.botPort[0];
+        dims.steamPortSpace = params.valvePorts.botPort[1] + params.valvePorts.botPort[0];
+        dims.exahustPortWidth = params.valvePorts.exPort[0] - params.valvePorts.exPort[1];
+        dims.valveWidth = params.valveSlide.botLand[1] - params.valveSlide.topLand[1];
+        dims.valveTopLand = params.valveSlide.topLand[0] - params.valveSlide.topLand[1];
+        dims.valveBottomLand = params.valveSlide.botLand[1] - params.valveSlide.botLand[0];
+        dims.topClearance = params.clearance[0];
+        dims.bottomClearance = params.clearance[1];
+        return dims;
+    }
+
+    // every design dimension, in design file column order. Files, bindings, indexes and fits are built from this table,
+    // so adding a member to s_designDimsT only needs a row here
+    inline constexpr s_designDimension designDimensions[] = {
+        {"bore", &s_designDims::bore},
+        {"stroke", &s_designDims::stroke},
+        {"conRod", &s_designDims::conRod},
+        {"valveTravel", &s_designDims::valveTravel},
+        {"valveConRod", &s_designDims::valveConRod},
+        {"eccentricAdvance", &s_designDims::eccentricAdvance},
+        {"steamPortWidth", &s_designDims::steamPortWidth},
+        {"steamPortSpace", &s_designDims::steamPortSpace},
+        {"exahustPortWidth", &s_designDims::exahustPortWidth},
+        {"valveWidth", &s_designDims::valveWidth},
+        {"valveTopLand", &s_designDims::valveTopLand},
+        {"valveBottomLand", &s_designDims::valveBottomLand},
+        {"topClearance", &s_designDims::topClearance},
+        {"bottomClearance", &s_designDims::bottomClearance}
+    };
+    static_assert(sizeof(designDimensions) / sizeof(designDimensions[0]) * sizeof(double) == sizeof(s_designDims),
+                  "every member of s_designDimsT needs a row in designDimensions");
+
+    /*!
+     * checks engine parameters for serious errors (like con rod shorter than stroke). Does not check the critical points.
+     */
+    template <typename T>
+    constexpr ErrorEnum checkGeometry(const s_engineParamsT<T> &params)
+    {
+        // check the basic stuff
+        if (params.conRod <= params.stroke)
+            return ErrorEnum::error;
+        if (params.valveConRod <= params.valveTravel)
+            return ErrorEnum::error;
+        if (params.clearance[0] <= 0 || params.clearance[1] <= 0)           // nothing for the compression to compress into
+            return ErrorEnum::error;
+
+        //valve porting checks
+        if (params.valvePorts.topPort[0] <= params.valvePorts.topPort[1])    // top port values reversed
+            return ErrorEnum::error;
+        if (params.valvePorts.exPort[0] <= params.valvePorts.exPort[1])      // exahust port values reversed
+            return ErrorEnum::error;
+        if (params.valvePorts.botPort[1] <= params.valvePorts.botPort[0])    // bot port values reversed
+            return ErrorEnum::error;
+        if (params.valvePorts.topPort[0] >= params.valvePorts.exPort[1])    // top bridge is <=0
+            return ErrorEnum::error;
+        if (params.valvePorts.botPort[0] <= params.valvePorts.exPort[0])    // bot bridge is <=0
+            return ErrorEnum::error;
+
+        return ErrorEnum::none;
+    }
+
+    /*!
+     * length of the overlap of the ranges lo1 to hi1 and lo2 to hi2, 0 if they do not overlap
+     */
+    template <typename T>
+    constexpr T overlap(T lo1, T hi1, T lo2, T hi2)
+    {
+        return std::max(T(0), std::min(hi1, hi2) - std::max(lo1, lo2));
+    }
+
+    /*!
+     * openings of the exahust path of one side of the piston
+     * \param params    engine parameters
+     * \param valvePos  valve position from neutral
+     * \param ret       if true, for the return stroke (bottom port)
+     */
+    template <typename T>
+    constexpr s_exahustFlowT<T> exahustFlow(const s_engineParamsT<T> &params, T valvePos, bool ret)
+    {
+        // the cavity is between the inside edges of the lands
+        T cavityLow = valvePos + params.valveSlide.topLand[0];
+        T cavityHigh = valvePos + params.valveSlide.botLand[0];
+        T portLow = ret ? params.valvePorts.botPort[0] : params.valvePorts.topPort[1];
+        T portHigh = ret ? params.valvePorts.botPort[1] : params.valvePorts.topPort[0];
+
+        s_exahustFlowT<T> flow{};
+        flow.portOpening = overlap(portLow, portHigh, cavityLow, cavityHigh);
+        flow.exahustOpening = overlap(params.valvePorts.exPort[1], params.valvePorts.exPort[0], cavityLow, cavityHigh);
+        flow.width = std::min(flow.portOpening, flow.exahustOpening);
+        return flow;
+    }
+
+    /*!
+     * finds the narrowest exahust port opening while one side exahausts.
+     * While the top port is open to the cavity, the cavity's lower edge is below the exahust port, so the exahust opening only
+     * shrinks as the valve moves further toward the top port. The smallest opening is therefore at the end of valve travel
+     * (and the same for the bottom side in the other direction).
+     * \param params    engine parameters
+     * \param ret       if true, for the return stroke (bottom side)
+     */
+    template <typename T>
+    constexpr s_exahustBottleneckT<T> exahustBottleneck(const s_engineParamsT<T> &params, bool ret)
+    {
+        // the valve is at -travel/2 with the eccentric at 0 degrees, and at +travel/2 at 180
+        s_exahustFlowT<T> flow = exahustFlow(params, ret ? params.valveTravel/2 : -params.valveTravel/2, ret);
+        s_exahustBottleneckT<T> bottleneck{};
+        bottleneck.exahustOpening = flow.exahustOpening;
+        bottleneck.crank = addAngles(ret ? T(180.0) : T(0.0), -params.eccentricAdvance);
+        bottleneck.portOpening = flow.portOpening;
+        bottleneck.ratio = (flow.portOpening > 0) ? flow.exahustOpening / flow.portOpening : T(0);
+        return bottleneck;
+    }
+
+    /*!
+     * valve gear loads at one eccentric position, for a constant crankshaft speed.
+     * The slide is pressed onto the face by the chest pressure over its back, less the cavity pressure under the cavity and
+     * a linear pressure drop across the lands: normalForce = (chest - exahust) * (cavity + lands/2) * portLength.
+     * The rod drives the slide against that friction and the valve inertia, and the eccentric rod carries the rod force
+     * at its angle to the valve motion.
+     * \param params    engine parameters
+     * \param settings  pressures, friction, mass and speed
+     * \param eccCos    cos of the eccentric angle (crank angle + eccentric advance)
+     * \param eccSin    sin of the eccentric angle
+     */
+    template <typename T>
+    s_valveLoadT<T> valveLoad(const s_engineParamsT<T> &params, const s_valveLoadSettingsT<T> &settings, T eccCos, T eccSin)
+    {
+        // valve motion from SVE::crank2Stroke and its derivatives, per radian of eccentric rotation
+        T r = params.valveTravel / 2;
+        T rSin = r * eccSin;
+        T s = std::sqrt(params.valveConRod * params.valveConRod - rSin*rSin);
+        T slope = rSin + rSin * r * eccCos / s;
+        T accel = r * eccCos + r * r * (eccCos*eccCos - eccSin*eccSin) / s + rSin*rSin * r*r * eccCos*eccCos / (s*s*s);
+
+        T cavity = params.valveSlide.botLand[0] - params.valveSlide.topLand[0];
+        T lands = (params.valveSlide.topLand[0] - params.valveSlide.topLand[1]) + (params.valveSlide.botLand[1] - params.valveSlide.botLand[0]);
+        T velocity = slope * settings.speed;
+
+        s_valveLoadT<T> load{};
+        load.normalForce = (settings.chestPressure - settings.exahustPressure) * (cavity + lands / 2) * settings.portLength;
+        load.friction = settings.friction * std::fabs(load.normalForce) * T((velocity > 0) - (velocity < 0));
+        load.inertia = settings.valveMass * accel * settings.speed * settings.speed;
+        load.rodForce = load.friction + load.inertia;
+        load.strapForce = load.rodForce * params.valveConRod / s;      // 1 / cos of the eccentric rod angle
+        load.eccentricTorque = load.rodForce * slope;
+        return load;
+    }
+
+    /*!
+     * calculates the crank angles of the 8 critical points (top inlet, cutoff, release, compression, then the same for the bottom)
+     * \param params         engine parameters
+     * \param strokeToCrank  function with the signature of SVE::stroke2Crank used to invert the valve motion
+     */
+    template <typename T, typename F>
+    constexpr std::array<T, 8> criticalPoints(const s_engineParamsT<T> &params, F strokeToCrank)
+    {
+        // linear position offsets from valve neutral
+        T offsetFIO = params.valvePorts.topPort[1] - params.valveSlide.topLand[1];      // forward intake/cutoff
+        T offsetFRC = params.valvePorts.topPort[0] - params.valveSlide.topLand[0];      // forward release/compression
+        T offsetRIO = params.valvePorts.botPort[1] - params.valveSlide.botLand[1];      // reverse intake/cutoff
+        T offsetRRC = params.valvePorts.botPort[0] - params.valveSlide.botLand[0];      // reverse release/compression
+
+        T halfTravel = params.valveTravel/2;
+        std::array<T, 8> ecc{};
+        ecc[0] = addAngles(strokeToCrank(halfTravel + offsetFIO, params.valveTravel, params.valveConRod, false), -params.eccentricAdvance);
+        ecc[1] = addAngles(strokeToCrank(halfTravel + offsetFIO, params.valveTravel, params.valveConRod, true), -params.eccentricAdvance);
+        ecc[2] = addAngles(strokeToCrank(halfTravel + offsetFRC, params.valveTravel, params.valveConRod, true), -params.eccentricAdvance);
+        ecc[3] = addAngles(strokeToCrank(halfTravel + offsetFRC, params.valveTravel, params.valveConRod, false), -params.eccentricAdvance);
+        ecc[4] = addAngles(strokeToCrank(halfTravel + offsetRIO, params.valveTravel, params.valveConRod, true), -params.eccentricAdvance);
+        ecc[5] = addAngles(strokeToCrank(halfTravel + offsetRIO, params.valveTravel, params.valveConRod, false), -params.eccentricAdvance);
+        ecc[6] = addAngles(strokeToCrank(halfTravel + offsetRRC, params.valveTravel, params.valveConRod, false), -params.eccentricAdvance);
+        ecc[7] = addAngles(strokeToCrank(halfTravel + offsetRRC, params.valveTravel, params.valveConRod, true), -params.eccentricAdvance);
+        return ecc;
+    }
+
+    /*!
+     * returns the cycle region for crank position <deg> given the 4 critical points of one side of the piston
+     */
+    template <typename T>
+    constexpr CycleEnum cycleRegion(T deg, const std::array<T, 4> &critP)
+    {
+        // calculate wrapped angle
+        T wrapped = addAngles(deg, 0);
+
+        // find (crit - wrapped) for all crit (crit >=0 by definition)
+        std::array<T, 4> diffs{};
+        for (int i=0; i<4; i++)
+            diffs[i] = critP[i] - wrapped;
+
+        // if any exact match choose the match
+        int startPoint = 0;
+        if (diffs[0] == 0){
+            startPoint = 0;
+        }else if (diffs[1] == 0){
+            startPoint = 1;
+        }else if (diffs[2] == 0){
+            startPoint = 2;
+        }else if (diffs[3] == 0){
+            startPoint = 3;
+        }else if (diffs[0] > 0 && diffs[1] > 0 && diffs[2] > 0 && diffs[3] > 0){ // if all diff + choose largest
+            T maxDiff = 0;
+            for (int i=0; i<4; i++){
+                if (diffs[i] > maxDiff){
+                    maxDiff = diffs[i];
+                    startPoint = i;
+                }
+            }
+        }else{ // if any - choose largest that is < 0
+            T maxDiff = -1000;
+            for (int i=0; i<4; i++){
+                if (diffs[i] < 0 && diffs[i] > maxDiff){
+                    maxDiff = diffs[i];
+                    startPoint = i;
+                }
+            }
+        }
+
+        switch (startPoint){
+        case 1:
+            return CycleEnum::expansion;
+        case 2:
+            return CycleEnum::exahust;
+        case 3:
+            return CycleEnum::compression;
+        default:
+            return CycleEnum::intake;
+        }
+    }
+
+    /*!
+     * returns the index of the next point after <deg> (with wrap). index is into <points>
+     */
+    template <typename T>
+    constexpr int nextPoint(T deg, const std::array<T, 4> &points)
+    {
+        T wrapped = addAngles(deg, 0);                                          //get wrapped version of deg
+        int next = -1;
+        int first = 0;
+        for (int i=0; i<4; i++){
+            if (points[i] > wrapped && (next == -1 || points[i] < points[next]))  // smallest point larger than wrapped
+                next = i;
+            if (points[i] < points[first])                                      // smallest point overall, for wrapping around
+                first = i;
+        }
+        // didn't find a next, must wrap around to the beginning
+        return (next == -1) ? first : next;
+    }
+
+    // resolution for adaptive sampling of a curve that is plotted. Scales are in pixels per unit
+    template <typename T>
+    struct SampleResolution
+    {
+        T viewLower;            // x range currently visible, sampled at the view scales
+        T viewUpper;
+        T viewXScale;
+        T viewYScale;
+        T xScale;               // scales used outside the visible range (the whole curve)
+        T yScale;
+        T tolerance;            // largest allowed distance (pixels) between the curve and the straight lines drawn between samples
+    };
+
+    /*!
+     * bisects the chord from (xa, ya) to (xb, yb) until the curve is within tolerance of the straight lines, appending the new samples (not xa)
+     */
+    template <typename T, typename F, typename Container>
+    void refineChord(F &f, T xa, T ya, T xb, T yb, const SampleResolution<T> &resolution, int depth, Container &x, Container &y)
+    {
+        T xm = (xa + xb) / 2;
+        T ym = f(xm);
+        bool inView = xb >= resolution.viewLower && xa <= resolution.viewUpper;
+        T xScale = inView ? resolution.viewXScale : resolution.xScale;
+        T yScale = inView ? resolution.viewYScale : resolution.yScale;
+
+        // distance in pixels of the midpoint sample from the chord
+        T dx = (xb - xa) * xScale;
+        T dy = (yb - ya) * yScale;
+        T length = std::sqrt(dx*dx + dy*dy);
+        T error = (length > 0) ? std::fabs(dx * (ym - ya) * yScale - dy * (xm - xa) * xScale) / length : T(0);
+
+        if (error > resolution.tolerance && depth > 0){
+            refineChord(f, xa, ya, xm, ym, resolution, depth - 1, x, y);
+            refineChord(f, xm, ym, xb, yb, resolution, depth - 1, x, y);
+        }else{
+            x.push_back(xb);
+            y.push_back(yb);
+        }
+    }
+
+    /*!
+     * samples f on x0 to x1 with points only where they are needed to draw the curve within resolution.tolerance pixels
+     * \param f             function to sample
+     * \param x0            first x
+     * \param x1            last x
+     * \param resolution    pixel scales and tolerance
+     * \param x             sample x values are appended here (any container with push_back)
+     * \param y             sample y values are appended here
+     */
+    template <typename T, typename F, typename Container>
+    void sampleAdaptive(F f, T x0, T x1, const SampleResolution<T> &resolution, Container &x, Container &y)
+    {
+        // start from a coarse uniform grid so narrow features are not stepped over, then refine each chord
+        const int initialSteps = 16;
+        const int maxDepth = 20;
+        T xa = x0;
+        T ya = f(x0);
+        x.push_back(xa);
+        y.push_back(ya);
+        for (int i=1; i<=initialSteps; i++){
+            T xb = (i == initialSteps) ? x1 : x0 + (x1 - x0) * i / initialSteps;
+            T yb = f(xb);
+            refineChord(f, xa, ya, xb, yb, resolution, maxDepth, x, y);
+            xa = xb;
+            ya = yb;
+        }
+    }
 }
 
 /*!
  * Holds functional parameters for a sliding valve, double acting engine and provides methods for calculating cycle information.
+ * <T> is the scalar type used for all calculations.
+ * Only setEngineParams() changes the engine; the const queries can be called from any number of threads at once.
+ * To share a changing engine with worker threads, publish immutable copies with SVE::EnginePublisher (enginesnapshot.h).
  */
-class SlideValveEngine
+template <typename T>
+class SlideValveEngineT
 {
 public:
-    SlideValveEngine();
-    SlideValveEngine(s_engineParams params);
-    ~SlideValveEngine();
-
-    ErrorEnum setEngineParams(s_engineParams newParams);        // Validates the new parameters, and only sets them if they are ok
-    s_engineParams getEngineParams();    
-
-    std::array<double, 4> topCriticalPoints();
-    std::array<double, 4> botCriticalPoints();
-    std::array<double, 8> criticalPoints();
-
-    double crankInlet(bool ret);
-    double crankCutoff(bool ret);
-    double crankRelease(bool ret);
-    double crankCompression(bool ret);
-    double stroke2Crank(double pos, bool ret);
-    double crank2Stroke(double deg);
-    double valvePos2Crank(double pos, bool ret);
-    double crank2ValvePos(double deg);
+    SlideValveEngineT();
+    SlideValveEngineT(s_engineParamsT<T> params);
+    ~SlideValveEngineT();
+
+    ErrorEnum setEngineParams(s_engineParamsT<T> newParams);        // Validates the new parameters, and only sets them if they are ok
+    s_engineParamsT<T> getEngineParams() const;
+    void prepareTables();                                           // use the shared kinematic tables for bulk position queries
+
+    std::array<T, 4> topCriticalPoints() const;
+    std::array<T, 4> botCriticalPoints() const;
+    std::array<T, 8> criticalPoints() const;
+
+    T crankInlet(bool ret) const;
+    T crankCutoff(bool ret) const;
+    T crankRelease(bool ret) const;
+    T crankCompression(bool ret) const;
+    T stroke2Crank(T pos, bool ret) const;
+    T crank2Stroke(T deg) const;
+    T valvePos2Crank(T pos, bool ret) const;
+    T crank2ValvePos(T deg) const;
+    T crank2ValveSlope(T deg) const;    // valve travel per degree of crank rotation
+    T crank2ValveAccel(T deg) const;    // second derivative of crank2ValvePos, per degree^2
 
     // returns the cycle region corresponding to the crank position. if ret is true, calculates for return stroke.
-    CycleEnum crank2TopCycle(double deg);
-    CycleEnum crank2BotCycle(double deg);
+    CycleEnum crank2TopCycle(T deg) const;
+    CycleEnum crank2BotCycle(T deg) const;
 
     // these functions return the next crank position after deg which hits a critical point
-    int nextTopCriticalPoint(double deg);       // returns the index of the next top critical point after deg
-    int nextBotCriticalPoint(double deg);       // returns the index of the next bottom critical point after deg
+    int nextTopCriticalPoint(T deg) const; // returns the index of the next top critical point after deg
+    int nextBotCriticalPoint(T deg) const; // returns the index of the next bottom critical point after deg
+
+    // cylinder volume of one end (including its clearance) at a crank position. if ret is true gives value for the bottom end
+    T cylinderVolume(T deg, bool ret) const;
 
     // returns the volume swept by the piston during inlet. if ret is true gives value for return stroke
-    double inletVolume(bool ret);
+    T inletVolume(bool ret) const;
+
+    T expansionVolume(bool ret) const;
 
-    double expansionVolume(bool ret);
+    T compressionVolume(bool ret) const;
 
-    double compressionVolume(bool ret);
+    T cushionRatio(bool ret) const;     // volume when the exahust closes / volume at the end of compression
+    T cushionPressure(bool ret, T exahustPressure, T exponent) const;  // pressure at the end of compression, p V^exponent = const
+
+    T metric(MetricEnum metric, bool ret) const; // figure of merit for one side of the piston. if ret is true gives value for return stroke
+
+    s_exahustFlowT<T> exahustFlow(T deg, bool ret) const;      // exahust path openings at crank position deg. if ret is true gives value for return stroke
+    s_exahustBottleneckT<T> exahustBottleneck(bool ret) const; // narrowest exahust port opening while exahausting. if ret is true gives value for return stroke
+    s_valveLoadT<T> valveLoad(T deg, const s_valveLoadSettingsT<T> &settings) const;   // valve rod and eccentric loads at crank position deg
 
 private:
-    s_engineParams _engineParams;    
+    s_engineParamsT<T> _engineParams;
     // the critical points only change when engine parameters change. no need to calculate them every time
-    ErrorEnum calcCriticalPoints(s_engineParams params);    // uses passed in engine parameters, if no error is encountered, updates the internal critical point values
-    ErrorEnum validateSettings(s_engineParams params);      // checks engine parameters for serious errors (like con rod shorter than stroke)
-    CycleEnum crank2Cycle(double deg, bool ret);
-    int nextPoint(double deg, std::array<double, 4> points);    // returns the index of the next point (with wrap). index is into <points>
-    double _criticalPoints[8];
-    double _forwardValveNeutral;                            // angular position of the eccentric when the valve is in the neutral position (1/2 its total travel)
-    double _returnValveNeutral;                            // angular position of the eccentric when the valve is in the neutral position (1/2 its total travel)
+    ErrorEnum calcCriticalPoints(s_engineParamsT<T> params);    // uses passed in engine parameters, if no error is encountered, updates the internal critical point values
+    ErrorEnum validateSettings(s_engineParamsT<T> params);      // checks engine parameters for serious errors (like con rod shorter than stroke)
+    CycleEnum crank2Cycle(T deg, bool ret) const;
+    T compressionEndVolume(bool ret) const;             // smallest volume of one end while it compresses
+    int nextPoint(T deg, std::array<T, 4> points) const; // returns the index of the next point (with wrap). index is into <points>
+    T _criticalPoints[8];
+    T _forwardValveNeutral;                            // angular position of the eccentric when the valve is in the neutral position (1/2 its total travel)
+    T _returnValveNeutral;                            // angular position of the eccentric when the valve is in the neutral position (1/2 its total travel)
+    std::shared_ptr<const SVE::CrankTable<T>> _strokeTable;   // piston position table, null until prepareTables() or if not accurate enough for this geometry
+    std::shared_ptr<const SVE::CrankTable<T>> _valveTable;    // valve position table (from valve TDC), null until prepareTables() or if not accurate enough
 };
 
+// instantiated in slidevalveengine.cpp
+extern template class SlideValveEngineT<float>;
+extern template class SlideValveEngineT<double>;
+extern template class SlideValveEngineT<long double>;
+
+typedef SlideValveEngineT<float> SlideValveEngineF;
+typedef SlideValveEngineT<double> SlideValveEngine;
+typedef SlideValveEngineT<long double> SlideValveEngineL;
+
 #endif // SLIDEVALVEENGINE_H
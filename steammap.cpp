@@ -0,0 +1,158 @@
+#include "steammap.h"
+#include <cmath>
+#include <limits>
+
+namespace {
+    /*!
+     * work of a polytropic change p V^n = const from volume1 (at pressure1) to volume2
+     */
+    double polytropicWork(double pressure1, double volume1, double volume2, double n)
+    {
+        return pressure1 * volume1 * (std::pow(volume2 / volume1, 1 - n) - 1) / (1 - n);
+    }
+
+    // map of the grid size with every value NaN
+    SVE::SteamMap emptyMap(int nr, int np)
+    {
+        SVE::SteamMap map;
+        map.rpmCount = nr;
+        map.pressureCount = np;
+        map.steamPerRevolution.assign(nr * np, std::numeric_limits<double>::quiet_NaN());
+        map.indicatedWork.assign(nr * np, std::numeric_limits<double>::quiet_NaN());
+        map.indicatedPower.assign(nr * np, std::numeric_limits<double>::quiet_NaN());
+        map.steamRate.assign(nr * np, std::numeric_limits<double>::quiet_NaN());
+        map.waterRate.assign(nr * np, std::numeric_limits<double>::quiet_NaN());
+        return map;
+    }
+
+    // fills grid point k from the steam and work per revolution
+    void setPoint(SVE::SteamMap &map, int k, double rpm, double steam, double work, const SVE::SteamMapSettings &settings)
+    {
+        map.steamPerRevolution[k] = steam;
+        map.indicatedWork[k] = work;
+        map.indicatedPower[k] = work * rpm / 60 / settings.powerUnit;
+        map.steamRate[k] = steam * rpm * 60;
+        map.waterRate[k] = (work > 0) ? steam * 3600 * settings.powerUnit / work : std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+/*!
+ * settings for psi, inches, lb and hp, exahausting to atmosphere. The density fit is within 0.5% of the saturated steam
+ * tables from 15 to 200 psia
+ */
+SVE::SteamMapSettings SVE::defaultSteamMapSettings()
+{
+    SteamMapSettings settings;
+    settings.exahustPressure = 14.7;
+    settings.polytropicExponent = 1.13;
+    settings.densityCoefficient = 1.712e-6;         // lb/in^3
+    settings.densityExponent = 0.942;
+    settings.powerUnit = 6600.0;
+    settings.flow = PortFlowModel::defaultSettings();
+    return settings;
+}
+
+/*!
+ * ideal cycle steam consumption and indicated power of one design over a grid of speeds and chest pressures
+ * \param params    engine geometry
+ * \param rpm       speeds
+ * \param pressures steam chest pressures (absolute)
+ * \param settings  back pressure, polytropic exponent, steam density fit and power unit
+ * \return the map, rpm major
+ */
+SVE::SteamMap SVE::steamMap(const s_engineParamsT<double> &params, const std::vector<double> &rpm, const std::vector<double> &pressures,
+                            const SteamMapSettings &settings)
+{
+    const int nr = static_cast<int>(rpm.size());
+    const int np = static_cast<int>(pressures.size());
+    SteamMap map = emptyMap(nr, np);
+
+    thread_local SlideValveEngine engine;
+    if (engine.setEngineParams(params) != ErrorEnum::none)
+        return map;
+
+    // coefficients of the chest and back pressure in the work, and the volumes setting the steam, summed over both ends
+    const double n = settings.polytropicExponent;
+    const double back = settings.exahustPressure;
+    const std::array<double, 8> points = engine.criticalPoints();
+    double supplyWork = 0;
+    double backWork = 0;
+    double cutoffVolume = 0;
+    double compressionVolume = 0;
+    for (int e=0; e<2; e++){
+        bool ret = (e == 1);
+        double inlet = engine.cylinderVolume(points[e * 4], ret);
+        double cutoff = engine.cylinderVolume(points[e * 4 + 1], ret);
+        double release = engine.cylinderVolume(points[e * 4 + 2], ret);
+        double compression = engine.cylinderVolume(points[e * 4 + 3], ret);
+        supplyWork += (cutoff - inlet) + polytropicWork(1, cutoff, release, n);
+        backWork += (compression - release) + polytropicWork(1, compression, inlet, n);
+        cutoffVolume += cutoff;
+        compressionVolume += compression;
+    }
+    double cushionSteam = settings.densityCoefficient * std::pow(back, settings.densityExponent) * compressionVolume;
+
+    for (int j=0; j<np; j++){
+        // steam and work per revolution do not depend on the speed in the ideal cycle
+        double work = pressures[j] * supplyWork + back * backWork;
+        double steam = settings.densityCoefficient * std::pow(pressures[j], settings.densityExponent) * cutoffVolume - cushionSteam;
+        for (int i=0; i<nr; i++)
+            setPoint(map, i * np + j, rpm[i], steam, work, settings);
+    }
+    return map;
+}
+
+/*!
+ * steam consumption and indicated power of one design over a grid of speeds and chest pressures, from the port flow model.
+ * The steam is the net flow through the admission ports
+ * \param params    engine geometry
+ * \param rpm       speeds
+ * \param pressures steam chest pressures (absolute)
+ * \param settings  back pressure, port flow settings, steam density fit and power unit
+ * \return the map, rpm major
+ */
+SVE::SteamMap SVE::speedCorrectedSteamMap(const s_engineParamsT<double> &params, const std::vector<double> &rpm,
+                                          const std::vector<double> &pressures, const SteamMapSettings &settings)
+{
+    const int nr = static_cast<int>(rpm.size());
+    const int np = static_cast<int>(pressures.size());
+    SteamMap map = emptyMap(nr, np);
+    if (np == 0)
+        return map;
+
+    // the geometry tables do not depend on the chest pressure, so they are built once for the whole grid
+    PortFlowModel::Settings flow = settings.flow;
+    flow.supplyPressure = pressures[0];
+    flow.exahustPressure = settings.exahustPressure;
+    PortFlowModel model;
+    if (model.setDesign(params, flow) != ErrorEnum::none)
+        return map;
+
+    for (int j=0; j<np; j++){
+        model.setSupplyPressure(pressures[j]);
+        // the admitted volumes are at chest pressure, so one density per column
+        double density = settings.densityCoefficient * std::pow(pressures[j], settings.densityExponent);
+        std::vector<PortFlowModel::Result> results = model.sweep(rpm);
+        for (int i=0; i<nr; i++){
+            const PortFlowModel::Result &result = results[i];
+            if (!result.converged)
+                continue;
+            double steam = density * (result.admittedVolume[0] + result.admittedVolume[1]);
+            setPoint(map, i * np + j, rpm[i], steam, result.indicatedWork, settings);
+        }
+    }
+    return map;
+}
+
+/*!
+ * ideal cycle steam maps of many designs (for example a sweep) on the same grid
+ */
+std::vector<SVE::SteamMap> SVE::steamMaps(const std::vector<s_engineParamsT<double>> &designs, const std::vector<double> &rpm,
+                                          const std::vector<double> &pressures, const SteamMapSettings &settings)
+{
+    std::vector<SteamMap> maps;
+    maps.reserve(designs.size());
+    for (const s_engineParamsT<double> &params : designs)
+        maps.push_back(steamMap(params, rpm, pressures, settings));
+    return maps;
+}
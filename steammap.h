@@ -0,0 +1,58 @@
+#ifndef STEAMMAP_H
+#define STEAMMAP_H
+
+#include <vector>
+#include "portflow.h"
+#include "slidevalveengine.h"
+
+namespace SVE {
+    /*!
+     * Steam consumption and indicated power of a design over a grid of speeds and steam chest pressures.
+     * steamMap() uses the ideal indicator cycle (chest pressure until cutoff, polytropic expansion to release, back pressure
+     * until compression, polytropic compression of the cushion steam). Both the work and the steam per revolution are linear
+     * in simple functions of the chest pressure, with coefficients that only depend on the cylinder volumes at the critical points:
+     *     work = chestPressure * supplyWork + backPressure * backWork
+     *     steam = density(chestPressure) * cutoffVolume - density(backPressure) * compressionVolume
+     * so each design is set up once and the whole map is one pass over the grid (about 80 us for 64x64). This is the batch
+     * path for sweeps, but the ideal cycle does not depend on the speed: only the power and steam rate scale with rpm.
+     * speedCorrectedSteamMap() instead runs the port flow model (see PortFlowModel) at every grid point, so wiredrawing lowers
+     * the cylinder pressures, the admitted steam and the work as the speed rises. The design is tabulated once, but each point
+     * is a full port flow integration (a few ms), so a map of a few hundred points takes around a second.
+     * The steam is the indicated steam (cylinder condensation and leakage not included), saturated steam density is a
+     * p^exponent power law fit.
+     * Usage:
+     *     SVE::SteamMap map = SVE::steamMap(engine.getEngineParams(), rpm, pressures, SVE::defaultSteamMapSettings());
+     *     double rate = map.waterRate[i * map.pressureCount + j];
+     */
+    struct SteamMapSettings
+    {
+        double exahustPressure;         // back pressure (absolute)
+        double polytropicExponent;      // p V^n = const during expansion and compression (ideal cycle)
+        double densityCoefficient;      // saturated steam density = densityCoefficient * p^densityExponent
+        double densityExponent;
+        double powerUnit;               // work per second per unit of power (6600 in lbf/s = 1 hp)
+        PortFlowModel::Settings flow;   // speed corrected map only, its pressures are replaced by the grid and exahustPressure
+    };
+
+    // results on the rpm x pressure grid, rpm major: value[i * pressureCount + j] is at rpm[i] and pressures[j]
+    struct SteamMap
+    {
+        int rpmCount;
+        int pressureCount;
+        std::vector<double> steamPerRevolution;     // steam mass admitted per revolution, both ends
+        std::vector<double> indicatedWork;          // work per revolution
+        std::vector<double> indicatedPower;         // in powerUnit
+        std::vector<double> steamRate;              // steam mass per hour
+        std::vector<double> waterRate;              // steam mass per powerUnit hour, NaN where the cycle does no work
+    };
+
+    SteamMapSettings defaultSteamMapSettings();     // psi, inches, lb and hp
+    SteamMap steamMap(const s_engineParamsT<double> &params, const std::vector<double> &rpm, const std::vector<double> &pressures,
+                      const SteamMapSettings &settings);   // all NaN for an invalid design
+    SteamMap speedCorrectedSteamMap(const s_engineParamsT<double> &params, const std::vector<double> &rpm,
+                                    const std::vector<double> &pressures, const SteamMapSettings &settings);   // NaN where the flow did not converge
+    std::vector<SteamMap> steamMaps(const std::vector<s_engineParamsT<double>> &designs, const std::vector<double> &rpm,
+                                    const std::vector<double> &pressures, const SteamMapSettings &settings);   // ideal cycle maps
+}
+
+#endif // STEAMMAP_H
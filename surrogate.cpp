@@ -0,0 +1,338 @@
+#include "surrogate.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace {
+    const int maxInputs = 12;
+    const int maxDegreeLimit = 8;
+
+    // exponents of every monomial of <inputs> variables with total degree <= degree, lowest degree first: terms[term * inputs + input]
+    std::vector<int> monomials(int inputs, int degree)
+    {
+        std::vector<int> terms;
+        std::vector<int> exponent(inputs, 0);
+        for (int total=0; total<=degree; total++){
+            // all ways of splitting <total> over the inputs
+            std::function<void(int, int)> split = [&](int k, int left){
+                if (k == inputs - 1){
+                    exponent[k] = left;
+                    terms.insert(terms.end(), exponent.begin(), exponent.end());
+                    return;
+                }
+                for (int e=left; e>=0; e--){
+                    exponent[k] = e;
+                    split(k + 1, left - e);
+                }
+            };
+            split(0, total);
+        }
+        return terms;
+    }
+
+    /*!
+     * Cholesky factorization in place (lower triangle), false if the matrix is not positive definite
+     */
+    bool cholesky(std::vector<double> &a, int m)
+    {
+        for (int j=0; j<m; j++){
+            double d = a[j*m + j];
+            for (int k=0; k<j; k++)
+                d -= a[j*m + k] * a[j*m + k];
+            if (!(d > 0))
+                return false;
+            a[j*m + j] = std::sqrt(d);
+            for (int i=j+1; i<m; i++){
+                double s = a[i*m + j];
+                for (int k=0; k<j; k++)
+                    s -= a[i*m + k] * a[j*m + k];
+                a[i*m + j] = s / a[j*m + j];
+            }
+        }
+        return true;
+    }
+
+    // solves L x = b in place with the factor from cholesky()
+    void forwardSolve(const std::vector<double> &l, int m, double *b)
+    {
+        for (int i=0; i<m; i++){
+            for (int k=0; k<i; k++)
+                b[i] -= l[i*m + k] * b[k];
+            b[i] /= l[i*m + i];
+        }
+    }
+
+    // solves L L' x = b in place with the factor from cholesky()
+    void choleskySolve(const std::vector<double> &l, int m, double *b)
+    {
+        for (int i=0; i<m; i++){
+            for (int k=0; k<i; k++)
+                b[i] -= l[i*m + k] * b[k];
+            b[i] /= l[i*m + i];
+        }
+        for (int i=m-1; i>=0; i--){
+            for (int k=i+1; k<m; k++)
+                b[i] -= l[k*m + i] * b[k];
+            b[i] /= l[i*m + i];
+        }
+    }
+
+    // b' (A'A)^-1 b = |L^-1 b|^2, with the lower triangular inverse factor
+    double leverage(const std::vector<double> &inverseFactor, int m, const double *b)
+    {
+        double sum = 0;
+        for (int i=0; i<m; i++){
+            double row = 0;
+            for (int j=0; j<=i; j++)
+                row += inverseFactor[i*m + j] * b[j];
+            sum += row*row;
+        }
+        return sum;
+    }
+}
+
+SVE::MetricSurrogate::MetricSurrogate()
+{
+    clear();
+}
+
+/*!
+ * fits the surrogate to sweep results
+ * \param designs   sampled designs, all equal except in the <inputs> dimensions
+ * \param values    metric of each design, NaN where the design is invalid
+ * \param inputs    the swept dimensions
+ * \param metric    metric the values are (used for the exact fallback)
+ * \param ret       true if the values are for the return stroke
+ * \param maxDegree highest polynomial degree tried
+ * \return false if there are too few valid samples to fit even a linear surrogate
+ */
+bool SVE::MetricSurrogate::fit(const std::vector<s_designDims> &designs, const std::vector<double> &values, const std::vector<Dimension> &inputs,
+                               MetricEnum metric, bool ret, int maxDegree)
+{
+    clear();
+    int k = static_cast<int>(inputs.size());
+    if (k == 0 || k > maxInputs || designs.size() != values.size())
+        return false;
+
+    std::vector<int> samples;
+    for (size_t i=0; i<values.size(); i++)
+        if (std::isfinite(values[i]))
+            samples.push_back(static_cast<int>(i));
+    if (samples.empty())
+        return false;
+
+    _inputs = inputs;
+    _metric = metric;
+    _ret = ret;
+    _base = designs[samples[0]];
+    for (const s_designDimension &dimension : designDimensions)
+        if (std::find(inputs.begin(), inputs.end(), dimension.member) == inputs.end())
+            _fixed.push_back(dimension.member);
+    _lower.assign(k, std::numeric_limits<double>::infinity());
+    _upper.assign(k, -std::numeric_limits<double>::infinity());
+    for (int i : samples){
+        for (int j=0; j<k; j++){
+            _lower[j] = std::min(_lower[j], designs[i].*(inputs[j]));
+            _upper[j] = std::max(_upper[j], designs[i].*(inputs[j]));
+        }
+    }
+
+    std::vector<double> x(samples.size() * k);
+    for (size_t s=0; s<samples.size(); s++){
+        if (!scaledInputs(designs[samples[s]], &x[s * k])){
+            clear();
+            return false;           // a design differs from the base in a dimension that is not an input
+        }
+    }
+
+    // fit each degree, keep the one with the smallest leave-one-out error
+    int n = static_cast<int>(samples.size());
+    double bestPress = std::numeric_limits<double>::infinity();
+    for (int degree=1; degree<=std::min(maxDegree, maxDegreeLimit); degree++){
+        std::vector<int> exponents = monomials(k, degree);
+        int m = static_cast<int>(exponents.size()) / k;
+        if (m > maxTerms || n < 2 * m)
+            break;
+        _exponents = exponents;
+
+        // normal equations, with a tiny ridge so a degenerate sample layout still factors
+        std::vector<double> a(m * m, 0);
+        std::vector<double> rhs(m, 0);
+        std::vector<double> b(m);
+        for (int s=0; s<n; s++){
+            basis(&x[s * k], degree, b.data());
+            for (int i=0; i<m; i++){
+                rhs[i] += b[i] * values[samples[s]];
+                for (int j=0; j<=i; j++)
+                    a[i*m + j] += b[i] * b[j];
+            }
+        }
+        double trace = 0;
+        for (int i=0; i<m; i++)
+            trace += a[i*m + i];
+        for (int i=0; i<m; i++){
+            a[i*m + i] += 1e-12 * trace / m;
+            for (int j=0; j<i; j++)
+                a[j*m + i] = a[i*m + j];
+        }
+        if (!cholesky(a, m))
+            break;
+
+        std::vector<double> coefficients = rhs;
+        choleskySolve(a, m, coefficients.data());
+        std::vector<double> inverseFactor(m * m, 0);
+        for (int j=0; j<m; j++){
+            std::vector<double> column(m, 0);
+            column[j] = 1;
+            forwardSolve(a, m, column.data());
+            for (int i=0; i<m; i++)
+                inverseFactor[i*m + j] = column[i];
+        }
+
+        // PRESS: leave-one-out residuals from the leverages, no refits needed
+        double press = 0;
+        for (int s=0; s<n; s++){
+            basis(&x[s * k], degree, b.data());
+            double fitted = 0;
+            for (int i=0; i<m; i++)
+                fitted += coefficients[i] * b[i];
+            double h = std::min(leverage(inverseFactor, m, b.data()), 0.999);
+            double r = (values[samples[s]] - fitted) / (1 - h);
+            press += r*r;
+        }
+        if (press < bestPress){
+            bestPress = press;
+            _degree = degree;
+            _coefficients = coefficients;
+            _inverseFactor = inverseFactor;
+        }
+    }
+
+    if (_degree == 0){
+        clear();
+        return false;
+    }
+    _exponents = monomials(k, _degree);
+    _rms = std::sqrt(bestPress / n);
+    return true;
+}
+
+void SVE::MetricSurrogate::clear()
+{
+    _inputs.clear();
+    _fixed.clear();
+    _metric = MetricEnum::cutoff;
+    _ret = false;
+    _base = SVE::designDims(SVE::defaultEngineParams<double>());
+    _lower.clear();
+    _upper.clear();
+    _degree = 0;
+    _exponents.clear();
+    _coefficients.clear();
+    _inverseFactor.clear();
+    _rms = std::numeric_limits<double>::infinity();
+}
+
+bool SVE::MetricSurrogate::isFitted() const
+{
+    return _degree > 0;
+}
+
+int SVE::MetricSurrogate::degree() const
+{
+    return _degree;
+}
+
+double SVE::MetricSurrogate::rms() const
+{
+    return _rms;
+}
+
+/*!
+ * estimates the metric from the surrogate only. Does not allocate, so it is cheap enough for every mouse move
+ * \return the estimate, with an infinite error outside the sampled box or off the base design (NaN if the geometry is invalid)
+ */
+SVE::MetricSurrogate::Estimate SVE::MetricSurrogate::estimate(const s_designDims &dims) const
+{
+    Estimate e{std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity(), false};
+    double x[maxInputs];
+    if (!isFitted() || !scaledInputs(dims, x))
+        return e;
+    if (SVE::checkGeometry(SVE::designParams(dims)) != ErrorEnum::none){
+        e.error = 0;
+        e.exact = true;             // known to be invalid without the engine
+        return e;
+    }
+
+    double b[maxTerms];
+    basis(x, _degree, b);
+    int m = static_cast<int>(_coefficients.size());
+    e.value = 0;
+    for (int i=0; i<m; i++)
+        e.value += _coefficients[i] * b[i];
+    e.error = _rms * std::sqrt(1 + leverage(_inverseFactor, m, b));
+    return e;
+}
+
+/*!
+ * estimates the metric, or calculates it with the engine when the surrogate's error is too large
+ * \param dims      design
+ * \param maxError  largest error accepted from the surrogate
+ */
+SVE::MetricSurrogate::Estimate SVE::MetricSurrogate::evaluate(const s_designDims &dims, double maxError) const
+{
+    Estimate e = estimate(dims);
+    if (e.error <= maxError)
+        return e;
+    return exact(dims);
+}
+
+SVE::MetricSurrogate::Estimate SVE::MetricSurrogate::exact(const s_designDims &dims) const
+{
+    // one engine per thread, so the shared kinematic tables are the only setup per call
+    thread_local SlideValveEngine engine;
+    Estimate e{std::numeric_limits<double>::quiet_NaN(), 0, true};
+    if (engine.setEngineParams(SVE::designParams(dims)) == ErrorEnum::none)
+        e.value = engine.metric(_metric, _ret);
+    return e;
+}
+
+bool SVE::MetricSurrogate::scaledInputs(const s_designDims &dims, double *x) const
+{
+    // every dimension that is not an input has to be the base design's
+    for (Dimension dimension : _fixed){
+        double base = _base.*dimension;
+        if (std::fabs(dims.*dimension - base) > 1e-9 * std::max(1.0, std::fabs(base)))
+            return false;
+    }
+
+    for (size_t j=0; j<_inputs.size(); j++){
+        double v = dims.*(_inputs[j]);
+        double span = _upper[j] - _lower[j];
+        if (v < _lower[j] - 1e-9 * span || v > _upper[j] + 1e-9 * span)
+            return false;
+        x[j] = (span > 0) ? 2 * (v - _lower[j]) / span - 1 : 0;
+    }
+    return true;
+}
+
+void SVE::MetricSurrogate::basis(const double *x, int degree, double *b) const
+{
+    // powers of each input, then one product per term
+    int k = static_cast<int>(_inputs.size());
+    double powers[maxInputs][maxDegreeLimit + 1];
+    for (int j=0; j<k; j++){
+        powers[j][0] = 1;
+        for (int e=1; e<=degree; e++)
+            powers[j][e] = powers[j][e - 1] * x[j];
+    }
+    const int *exponent = _exponents.data();
+    int m = static_cast<int>(_exponents.size()) / k;
+    for (int t=0; t<m; t++){
+        double term = 1;
+        for (int j=0; j<k; j++)
+            term *= powers[j][*exponent++];
+        b[t] = term;
+    }
+}
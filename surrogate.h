@@ -0,0 +1,65 @@
+#ifndef SURROGATE_H
+#define SURROGATE_H
+
+#include <vector>
+#include "slidevalveengine.h"
+
+namespace SVE {
+    /*!
+     * Polynomial surrogate of one design metric, fitted to sweep results, for estimates much cheaper than an engine evaluation.
+     * The inputs are the swept dimensions (scaled to -1..1 over the sampled box), every other dimension must match the sweep's
+     * base design. The degree (up to maxDegree) is picked by leave-one-out error, and each estimate carries an error from that
+     * error and the leverage of the query point, so estimates far from the samples (or outside the box) report a large error.
+     * evaluate() falls back to the exact engine when the error is larger than the caller allows.
+     * Usage:
+     *     SVE::MetricSurrogate surrogate;
+     *     surrogate.fit(designs, values, {&s_designDims::eccentricAdvance, &s_designDims::valveTravel}, MetricEnum::cutoff, false);
+     *     SVE::MetricSurrogate::Estimate e = surrogate.evaluate(dims, 0.1);     // exact if the estimate is not within 0.1
+     */
+    class MetricSurrogate
+    {
+    public:
+        typedef double s_designDims::*Dimension;
+
+        struct Estimate
+        {
+            double value;               // NaN if the design is invalid
+            double error;               // estimated error of value (one standard deviation), 0 if exact, infinity if the surrogate does not apply
+            bool exact;                 // value came from the engine
+        };
+
+        MetricSurrogate();
+
+        bool fit(const std::vector<s_designDims> &designs, const std::vector<double> &values, const std::vector<Dimension> &inputs,
+                 MetricEnum metric, bool ret, int maxDegree = 4);       // values are NaN for invalid designs, which are left out
+        void clear();
+        bool isFitted() const;
+        int degree() const;
+        double rms() const;                                             // leave-one-out RMS error over the samples
+
+        Estimate estimate(const s_designDims &dims) const;              // surrogate only
+        Estimate evaluate(const s_designDims &dims, double maxError) const;     // surrogate, or the engine if the error is above maxError
+        Estimate exact(const s_designDims &dims) const;
+
+    private:
+        static const int maxTerms = 120;                                // largest basis fitted
+
+        std::vector<Dimension> _inputs;
+        std::vector<Dimension> _fixed;                                  // the other dimensions
+        MetricEnum _metric;
+        bool _ret;
+        s_designDims _base;                                             // dimensions that are not inputs must match these
+        std::vector<double> _lower;                                     // sampled box of the inputs
+        std::vector<double> _upper;
+        int _degree;
+        std::vector<int> _exponents;                                    // exponent of each input in each term, [term * inputs + input]
+        std::vector<double> _coefficients;
+        std::vector<double> _inverseFactor;                             // inverse Cholesky factor of A'A (lower, row major), for the leverage of a query
+        double _rms;
+
+        bool scaledInputs(const s_designDims &dims, double *x) const;   // false if dims is outside the box or off the base design
+        void basis(const double *x, int degree, double *b) const;
+    };
+}
+
+#endif // SURROGATE_H
@@ -0,0 +1,129 @@
+#include "tracing.h"
+#include <mutex>
+#include <vector>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+std::atomic<bool> Trace::recording(false);
+
+namespace {
+    struct Event
+    {
+        const char *name;
+        char phase;             // 'X' complete, 'B' begin, 'E' end
+        qint64 start;
+        qint64 duration;
+        int thread;
+    };
+
+    std::mutex eventMutex;
+    std::vector<Event> events;
+    QString traceFile;
+    std::atomic<int> threadCount(0);
+
+    const QElapsedTimer &clock()
+    {
+        static QElapsedTimer timer = []{ QElapsedTimer t; t.start(); return t; }();
+        return timer;
+    }
+
+    int threadId()
+    {
+        // small sequential numbers read better in the trace viewer than native thread ids
+        thread_local int id = threadCount++;
+        return id;
+    }
+
+    void add(const char *name, char phase, qint64 start, qint64 duration)
+    {
+        Event event = {name, phase, start, duration, threadId()};
+        std::lock_guard<std::mutex> lock(eventMutex);
+        if (Trace::enabled())
+            events.push_back(event);
+    }
+}
+
+/*!
+ * starts a new recording, discarding any events not yet written
+ * \param fileName  trace file written by stop()
+ * \return false if already recording
+ */
+bool Trace::start(const QString &fileName)
+{
+    clock();
+    std::lock_guard<std::mutex> lock(eventMutex);
+    if (enabled())
+        return false;
+    events.clear();
+    events.reserve(1 << 16);
+    traceFile = fileName;
+    recording = true;
+    return true;
+}
+
+/*!
+ * stops recording and writes the events to the trace file
+ * \return true if the file was written
+ */
+bool Trace::stop()
+{
+    std::vector<Event> recorded;
+    QString name;
+    {
+        std::lock_guard<std::mutex> lock(eventMutex);
+        if (!enabled())
+            return false;
+        recording = false;
+        recorded.swap(events);
+        name = traceFile;
+    }
+
+    QFile file(name);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+
+    // times are in microseconds in the trace format
+    QTextStream out(&file);
+    qint64 pid = QCoreApplication::applicationPid();
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"args\":{\"name\":\"slideValveDesigner\"}}";
+    for (const Event &event : recorded){
+        out << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"gui\",\"ph\":\"" << event.phase
+            << "\",\"ts\":" << QString::number(event.start / 1000.0, 'f', 3);
+        if (event.phase == 'X')
+            out << ",\"dur\":" << QString::number(event.duration / 1000.0, 'f', 3);
+        out << ",\"pid\":" << pid << ",\"tid\":" << event.thread << "}";
+    }
+    out << "\n]}\n";
+    return out.status() == QTextStream::Ok;
+}
+
+QString Trace::fileName()
+{
+    std::lock_guard<std::mutex> lock(eventMutex);
+    return traceFile;
+}
+
+qint64 Trace::now()
+{
+    return clock().nsecsElapsed();
+}
+
+void Trace::complete(const char *name, qint64 start, qint64 end)
+{
+    add(name, 'X', start, end - start);
+}
+
+void Trace::begin(const char *name)
+{
+    if (enabled())
+        add(name, 'B', now(), 0);
+}
+
+void Trace::end(const char *name)
+{
+    if (enabled())
+        add(name, 'E', now(), 0);
+}
@@ -0,0 +1,64 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <atomic>
+#include <QString>
+
+/*!
+ * Scoped timing spans written as Chrome trace JSON (load the file in chrome://tracing or ui.perfetto.dev).
+ * Recording is started with the SVD_TRACE environment variable (file name) or the Tools menu.
+ * While recording is off a span costs one relaxed atomic load.
+ * Usage:
+ *     void MainWindow::drawCycleDiagram()
+ *     {
+ *         TRACE_SCOPE("drawCycleDiagram");
+ *         ...
+ */
+namespace Trace {
+    extern std::atomic<bool> recording;
+
+    inline bool enabled()
+    {
+        return recording.load(std::memory_order_relaxed);
+    }
+
+    bool start(const QString &fileName);                // starts recording, events are kept in memory until stop()
+    bool stop();                                        // stops recording and writes the file, returns false if it could not be written
+    QString fileName();                                 // file the current recording is written to
+    qint64 now();                                       // nanoseconds since the program started
+
+    // <name> must stay valid until the recording is written (use string literals)
+    void complete(const char *name, qint64 start, qint64 end);
+    void begin(const char *name);                       // for spans that do not fit in a scope (e.g. between two signals)
+    void end(const char *name);
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char *name)
+        {
+            _name = enabled() ? name : nullptr;
+            if (_name)
+                _start = now();
+        }
+
+        ~Scope()
+        {
+            if (_name)
+                complete(_name, _start, now());
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        const char *_name;
+        qint64 _start;
+    };
+}
+
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#endif // TRACING_H
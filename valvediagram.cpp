@@ -0,0 +1,264 @@
+#include "valvediagram.h"
+#include "tracing.h"
+
+ValveDiagram::ValveDiagram(s_engineParams params, const std::map<CycleEnum, QBrush> &regionBrush)
+{
+    _params = params;
+    _regionBrush = regionBrush;
+    _outlinePen = QPen(Qt::blue, 0);
+    _noPen = QPen(QColor(0,0,0,0));
+
+    // calculate some drawing parameters so the diagram looks nice
+    // Note 0,0 is the center of the valve face, and the cylinder axis is below the Y axis
+    _topPortWidth = params.valvePorts.topPort[0] - params.valvePorts.topPort[1];
+    _botPortWidth = params.valvePorts.botPort[1] - params.valvePorts.botPort[0];
+    _valveSizeParameter = params.valveTravel / 4;
+    _pistonWidth = params.bore / 8;
+    if (_pistonWidth < 1.5*_valveSizeParameter)
+        _pistonWidth = 1.5*_valveSizeParameter;
+    _outsideEdge = _pistonWidth + (params.stroke + _pistonWidth)/2;
+    _insideEdge = _outsideEdge - _pistonWidth;
+    _steamChestTop = 4*_valveSizeParameter;
+    _topEdge = _steamChestTop + _pistonWidth;
+    _portWall = 3 * ((_topPortWidth > _botPortWidth) ? _topPortWidth : _botPortWidth);
+    _cylinderBottom = -_portWall - params.bore;
+    _bottomEdge = _cylinderBottom - _pistonWidth;
+}
+
+/*!
+ * generates all the polygons of the diagram for one crank position
+ * \param stroke    piston position from TDC
+ * \param valvePos  valve position from neutral
+ * \param topCycle  cycle region of the top (forward) side of the piston, selects the shading
+ * \param botCycle  cycle region of the bottom (return) side of the piston
+ * \return          polygons in drawing order
+ */
+QVector<ValveDiagram::Shape> ValveDiagram::shapes(double stroke, double valvePos, CycleEnum topCycle, CycleEnum botCycle) const
+{
+    TRACE_SCOPE("ValveDiagram::shapes");
+    return backgroundShapes() + movingShapes(stroke, valvePos, topCycle, botCycle) + foregroundShapes();
+}
+
+/*!
+ * polygons that only depend on the engine parameters and are covered by the moving ones
+ */
+QVector<ValveDiagram::Shape> ValveDiagram::backgroundShapes() const
+{
+    QVector<Shape> shapes;
+    shapes.append({drawCylinder1(_outsideEdge, _insideEdge, _bottomEdge, _topEdge, _portWall, _pistonWidth), QBrush(QColor(0,0,0,255)), _outlinePen});
+    shapes.append({drawSteamChestShade(_insideEdge, _steamChestTop), _regionBrush.at(CycleEnum::intake), _noPen});      // steam chest is always full of full pressure steam
+    shapes.append({drawExahustShade(_portWall), _regionBrush.at(CycleEnum::exahust), _noPen});
+    return shapes;
+}
+
+/*!
+ * polygons that move or change shading with the crank position, the number and order of them does not change
+ * \param stroke    piston position from TDC
+ * \param valvePos  valve position from neutral
+ * \param topCycle  cycle region of the top (forward) side of the piston, selects the shading
+ * \param botCycle  cycle region of the bottom (return) side of the piston
+ */
+QVector<ValveDiagram::Shape> ValveDiagram::movingShapes(double stroke, double valvePos, CycleEnum topCycle, CycleEnum botCycle) const
+{
+    QVector<Shape> shapes;
+    shapes.append({drawForwardShade(stroke, _insideEdge, _portWall, _cylinderBottom, _pistonWidth), _regionBrush.at(topCycle), _noPen});
+    shapes.append({drawReverseShade(stroke, _insideEdge, _portWall, _cylinderBottom, _pistonWidth), _regionBrush.at(botCycle), _noPen});
+    shapes.append({drawPiston(stroke, _portWall, _cylinderBottom, _pistonWidth), QBrush(QColor(150,150,150,255)), _outlinePen});
+    shapes.append({drawSlide(valvePos, _valveSizeParameter), QBrush(QColor(150,150,150,255)), _outlinePen});
+    shapes.append({drawValveShade(valvePos, _valveSizeParameter), _regionBrush.at(CycleEnum::exahust), _noPen});
+    return shapes;
+}
+
+/*!
+ * polygons that only depend on the engine parameters and cover the edges of the moving ones
+ */
+QVector<ValveDiagram::Shape> ValveDiagram::foregroundShapes() const
+{
+    QVector<Shape> shapes;
+    shapes.append({drawCylinder2(_portWall, _insideEdge), QBrush(QColor(0,0,0,255)), _outlinePen});
+    return shapes;
+}
+
+/********************************* methods to generate graphical paths for the simulation diagram ******************************************************/
+
+QVector<QCPCurveData> ValveDiagram::drawSlide(double offset, double sizeParam) const{
+    TRACE_SCOPE("ValveDiagram::drawSlide");
+    QVector<QCPCurveData> data;
+    data.reserve(9);
+    const s_engineParams &params = _params;
+    int pointIndex = 0;
+    data.append(QCPCurveData(pointIndex++, offset + params.valveSlide.topLand[1], 0));
+    data.append(QCPCurveData(pointIndex++, offset + params.valveSlide.topLand[1], 2*sizeParam));
+    data.append(QCPCurveData(pointIndex++, offset + params.valveSlide.botLand[1], 2*sizeParam));
+    data.append(QCPCurveData(pointIndex++, offset + params.valveSlide.botLand[1], 0));
+    data.append(QCPCurveData(pointIndex++, offset + params.valveSlide.botLand[0], 0));
+    data.append(QCPCurveData(pointIndex++, offset + params.valveSlide.botLand[0], sizeParam));
+    data.append(QCPCurveData(pointIndex++, offset + params.valveSlide.topLand[0], sizeParam));
+    data.append(QCPCurveData(pointIndex++, offset + params.valveSlide.topLand[0], 0));
+    data.append(QCPCurveData(pointIndex++, offset + params.valveSlide.topLand[1], 0));
+    return data;
+}
+
+QVector<QCPCurveData> ValveDiagram::drawCylinder1(double outsideEdge, double insideEdge, double bottomEdge, double topEdge, double portWall, double piston) const{
+    TRACE_SCOPE("ValveDiagram::drawCylinder1");
+    QVector<QCPCurveData> data;
+    data.reserve(21);
+    const s_engineParams &params = _params;
+    double axis = -portWall - params.bore / 2;
+    double portWidth = portWall / 3;
+    int pointIndex = 0;
+    data.append(QCPCurveData(pointIndex++, -outsideEdge, bottomEdge));
+    data.append(QCPCurveData(pointIndex++, -outsideEdge, topEdge));
+    data.append(QCPCurveData(pointIndex++, outsideEdge, topEdge));
+    data.append(QCPCurveData(pointIndex++, outsideEdge, axis + piston / 2));
+    data.append(QCPCurveData(pointIndex++, insideEdge, axis + piston / 2));
+    data.append(QCPCurveData(pointIndex++, insideEdge, -portWidth ));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.botPort[1], -portWidth));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.botPort[1], 0));
+    data.append(QCPCurveData(pointIndex++, insideEdge, 0));
+    data.append(QCPCurveData(pointIndex++, insideEdge, topEdge - piston));
+    data.append(QCPCurveData(pointIndex++, -insideEdge, topEdge - piston));
+    data.append(QCPCurveData(pointIndex++, -insideEdge, 0));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.topPort[1], 0));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.topPort[1], -portWidth));
+    data.append(QCPCurveData(pointIndex++, -insideEdge, -portWidth));
+    data.append(QCPCurveData(pointIndex++, -insideEdge, axis - params.bore / 2));
+    data.append(QCPCurveData(pointIndex++, insideEdge, axis - params.bore / 2));
+    data.append(QCPCurveData(pointIndex++, insideEdge, axis - piston/2));
+    data.append(QCPCurveData(pointIndex++, outsideEdge, axis - piston/2));
+    data.append(QCPCurveData(pointIndex++, outsideEdge, bottomEdge));
+    data.append(QCPCurveData(pointIndex++, -outsideEdge, bottomEdge));
+
+
+    return data;
+}
+
+QVector<QCPCurveData> ValveDiagram::drawCylinder2(double portWall, double insideEdge) const{
+    TRACE_SCOPE("ValveDiagram::drawCylinder2");
+    QVector<QCPCurveData> data;
+    data.reserve(13);
+    const s_engineParams &params = _params;
+    double portWidth = portWall / 3;
+    int pointIndex = 0;
+    data.append(QCPCurveData(pointIndex++, -insideEdge + portWidth, -portWall));
+    data.append(QCPCurveData(pointIndex++, -insideEdge + portWidth, -portWall + portWidth));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.topPort[0], -portWall + portWidth));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.topPort[0], 0));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.exPort[1], 0));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.exPort[1], -2*portWidth));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.exPort[0], -2*portWidth));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.exPort[0], 0));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.botPort[0], 0));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.botPort[0], -portWall + portWidth));
+    data.append(QCPCurveData(pointIndex++, insideEdge - portWidth , -portWall + portWidth));
+    data.append(QCPCurveData(pointIndex++, insideEdge - portWidth , -portWall));
+    data.append(QCPCurveData(pointIndex++, -insideEdge + portWidth, -portWall));
+    return data;
+}
+
+QVector<QCPCurveData> ValveDiagram::drawPiston(double stroke, double portWall, double cylinderBottom, double pistonWidth) const{
+    TRACE_SCOPE("ValveDiagram::drawPiston");
+    QVector<QCPCurveData> data;
+    data.reserve(9);
+    const s_engineParams &params = _params;
+    double axis = (-portWall + cylinderBottom) / 2;
+    double leftEdge = -(params.stroke / 2) - pistonWidth/2;
+    int pointIndex = 0;
+    data.append(QCPCurveData(pointIndex++, stroke + leftEdge, cylinderBottom));
+    data.append(QCPCurveData(pointIndex++, stroke + leftEdge, -portWall));
+    data.append(QCPCurveData(pointIndex++, stroke + leftEdge + pistonWidth, -portWall));
+    data.append(QCPCurveData(pointIndex++, stroke + leftEdge + pistonWidth, axis + pistonWidth/2));
+    data.append(QCPCurveData(pointIndex++, stroke + leftEdge + 4*pistonWidth + params.stroke, axis + pistonWidth/2));
+    data.append(QCPCurveData(pointIndex++, stroke + leftEdge + 4*pistonWidth + params.stroke, axis - pistonWidth/2));
+    data.append(QCPCurveData(pointIndex++, stroke + leftEdge + pistonWidth, axis - pistonWidth/2));
+    data.append(QCPCurveData(pointIndex++, stroke + leftEdge + pistonWidth, cylinderBottom));
+    data.append(QCPCurveData(pointIndex++, stroke + leftEdge, cylinderBottom));
+    return data;
+}
+
+QVector<QCPCurveData> ValveDiagram::drawForwardShade(double stroke, double insideEdge, double portWall, double cylinderBottom, double pistonWidth) const{
+    TRACE_SCOPE("ValveDiagram::drawForwardShade");
+    QVector<QCPCurveData> data;
+    data.reserve(11);
+    const s_engineParams &params = _params;
+    double portWidth = portWall / 3;;
+    double leftEdge = -(params.stroke / 2) - pistonWidth/2;
+    int pointIndex = 0;
+    data.append(QCPCurveData(pointIndex++, -insideEdge, cylinderBottom));
+    data.append(QCPCurveData(pointIndex++, -insideEdge, -portWidth));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.topPort[1], -portWidth));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.topPort[1], 0));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.topPort[0], 0));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.topPort[0], -2*portWidth));
+    data.append(QCPCurveData(pointIndex++, -insideEdge + portWidth, -2*portWidth));
+    data.append(QCPCurveData(pointIndex++, -insideEdge + portWidth, -portWall));
+    data.append(QCPCurveData(pointIndex++, stroke + leftEdge, -portWall));
+    data.append(QCPCurveData(pointIndex++, stroke + leftEdge, cylinderBottom));
+    data.append(QCPCurveData(pointIndex++, -insideEdge, cylinderBottom));
+    return data;
+}
+
+QVector<QCPCurveData> ValveDiagram::drawReverseShade(double stroke, double insideEdge, double portWall, double cylinderBottom, double pistonWidth) const{
+    TRACE_SCOPE("ValveDiagram::drawReverseShade");
+    QVector<QCPCurveData> data;
+    data.reserve(11);
+    const s_engineParams &params = _params;
+    double portWidth = portWall / 3;
+    double rightEdge = -(params.stroke / 2) + pistonWidth/2;
+    int pointIndex = 0;
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.botPort[0], 0));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.botPort[1], 0));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.botPort[1], -portWidth));
+    data.append(QCPCurveData(pointIndex++, insideEdge, -portWidth));
+    data.append(QCPCurveData(pointIndex++, insideEdge, cylinderBottom));
+    data.append(QCPCurveData(pointIndex++, stroke + rightEdge, cylinderBottom));
+    data.append(QCPCurveData(pointIndex++, stroke + rightEdge, -portWall));
+    data.append(QCPCurveData(pointIndex++, insideEdge - portWidth, -portWall));
+    data.append(QCPCurveData(pointIndex++, insideEdge - portWidth, -2*portWidth));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.botPort[0], -2*portWidth));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.botPort[0], 0));
+    return data;
+}
+
+QVector<QCPCurveData> ValveDiagram::drawValveShade(double offset, double sizeParam) const{
+    TRACE_SCOPE("ValveDiagram::drawValveShade");
+    QVector<QCPCurveData> data;
+    data.reserve(5);
+    const s_engineParams &params = _params;
+    int pointIndex = 0;
+    data.append(QCPCurveData(pointIndex++, offset + params.valveSlide.botLand[0], 0));
+    data.append(QCPCurveData(pointIndex++, offset + params.valveSlide.topLand[0], 0));
+    data.append(QCPCurveData(pointIndex++, offset + params.valveSlide.topLand[0], sizeParam));
+    data.append(QCPCurveData(pointIndex++, offset + params.valveSlide.botLand[0], sizeParam));
+    data.append(QCPCurveData(pointIndex++, offset + params.valveSlide.botLand[0], 0));
+    return data;
+}
+
+QVector<QCPCurveData> ValveDiagram::drawSteamChestShade(double insideEdge, double steamChestTop) const{
+    TRACE_SCOPE("ValveDiagram::drawSteamChestShade");
+    QVector<QCPCurveData> data;
+    data.reserve(5);
+    int pointIndex = 0;
+    data.append(QCPCurveData(pointIndex++, -insideEdge, 0));
+    data.append(QCPCurveData(pointIndex++, -insideEdge, steamChestTop));
+    data.append(QCPCurveData(pointIndex++, insideEdge, steamChestTop));
+    data.append(QCPCurveData(pointIndex++, insideEdge, 0));
+    data.append(QCPCurveData(pointIndex++, -insideEdge, 0));
+    return data;
+}
+
+QVector<QCPCurveData> ValveDiagram::drawExahustShade(double portWall) const{
+    TRACE_SCOPE("ValveDiagram::drawExahustShade");
+    QVector<QCPCurveData> data;
+    data.reserve(5);
+    const s_engineParams &params = _params;
+    double portWidth = portWall / 3;
+    int pointIndex = 0;
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.exPort[0], 0));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.exPort[1], 0));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.exPort[1], -2*portWidth));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.exPort[0], -2*portWidth));
+    data.append(QCPCurveData(pointIndex++, params.valvePorts.exPort[0], 0));
+
+    return data;
+}
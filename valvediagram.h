@@ -0,0 +1,63 @@
+#ifndef VALVEDIAGRAM_H
+#define VALVEDIAGRAM_H
+
+#include <map>
+#include "qcustomplot.h"
+#include "slidevalveengine.h"
+
+/*!
+ * Generates the polygons of the valve (animation) diagram for one set of engine parameters.
+ * 0,0 is the center of the valve face, and the cylinder axis is below the Y axis.
+ * Only uses its own copy of the parameters, so it is safe to use from worker threads.
+ */
+class ValveDiagram
+{
+public:
+    // one filled polygon of the diagram
+    struct Shape
+    {
+        QVector<QCPCurveData> data;                 // in point index order, ready for QCPDataContainer::adopt()
+        QBrush brush;
+        QPen pen;
+    };
+
+    ValveDiagram(s_engineParams params, const std::map<CycleEnum, QBrush> &regionBrush);
+
+    QVector<Shape> shapes(double stroke, double valvePos, CycleEnum topCycle, CycleEnum botCycle) const;   // all polygons for one crank position, in drawing order
+
+    // the same polygons split by whether they move with the crank, drawn background, moving, foreground
+    QVector<Shape> backgroundShapes() const;                                                                // cylinder, steam chest and exahust passage
+    QVector<Shape> movingShapes(double stroke, double valvePos, CycleEnum topCycle, CycleEnum botCycle) const;  // cylinder shading, piston, slide and valve shading
+    QVector<Shape> foregroundShapes() const;                                                                // port walls and valve face
+
+private:
+    s_engineParams _params;
+    std::map<CycleEnum, QBrush> _regionBrush;
+    QPen _outlinePen;                       // default QCPCurve pen
+    QPen _noPen;
+
+    // drawing parameters so the diagram looks nice
+    double _topPortWidth;                   // width of the top steam port
+    double _botPortWidth;                   // width of the bottom steam port
+    double _valveSizeParameter;             // atomic unit for drawing the valve and steam chest heights
+    double _pistonWidth;                    // width of piston width/piston rod and outer walls
+    double _outsideEdge;                    // make the outside edge 1 piston width larger than the stroke on each side
+    double _insideEdge;
+    double _steamChestTop;
+    double _topEdge;
+    double _portWall;                       // wall between the cylinder bore and valve face = 3 time larger port
+    double _cylinderBottom;
+    double _bottomEdge;
+
+    QVector<QCPCurveData> drawSlide(double offset, double sizeParam) const;
+    QVector<QCPCurveData> drawCylinder1(double outsideEdge, double insideEdge, double bottomEdge, double topEdge, double portWall, double piston) const;                     // generates curve data for the outer part of the cylinder
+    QVector<QCPCurveData> drawCylinder2(double portWall, double insideEdge) const;                     // generates curve data for the inner part of the cylinder
+    QVector<QCPCurveData> drawForwardShade(double stroke, double insideEdge, double portWall, double cylinderBottom, double pistonWidth) const;     // draws a curve for shading the forward cylinder space given stroke (stroke is 0 at TDC)
+    QVector<QCPCurveData> drawReverseShade(double stroke, double insideEdge, double portWall, double cylinderBottom, double pistonWidth) const;     // draws a curve for shading the return cylinder space given stroke (stroke is 0 at TDC)
+    QVector<QCPCurveData> drawPiston(double stroke, double portWall, double cylinderBottom, double pistonWidth) const;
+    QVector<QCPCurveData> drawValveShade(double offset, double sizeParam) const;          // draws curve for shading the interior of the valve given valve position (position is 0 at valve neutral)
+    QVector<QCPCurveData> drawSteamChestShade(double insideEdge, double steamChestTop) const;               // draws a curve for shading the interior of the steam chest
+    QVector<QCPCurveData> drawExahustShade(double portWall) const;
+};
+
+#endif // VALVEDIAGRAM_H